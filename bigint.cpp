@@ -0,0 +1,183 @@
+#include "bigint.h"
+
+#include <catch.hpp>
+#include <array>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+
+Limbs random_limbs(std::mt19937_64& gen, size_t n) {
+    Limbs a(n);
+    for (auto& x : a) {
+        x = gen();
+    }
+    if (n > 0 && a.back() == 0) {
+        a.back() = 1;
+    }
+    return a;
+}
+
+// a mod p for a small p
+uint64_t mod(const Limbs& a, uint64_t p) {
+    uint64_t rem = 0;
+    divide(a, p, &rem);
+    return rem;
+}
+
+const Multiplication ALGORITHMS[] = {
+    Multiplication::schoolbook,
+    Multiplication::karatsuba,
+    Multiplication::toom3,
+    Multiplication::schonhage_strassen,
+    Multiplication::automatic,
+};
+
+const char* name(Multiplication algorithm) {
+    switch (algorithm) {
+    case Multiplication::schoolbook: return "schoolbook";
+    case Multiplication::karatsuba: return "Karatsuba";
+    case Multiplication::toom3: return "Toom-3";
+    case Multiplication::schonhage_strassen: return "Schönhage-Strassen";
+    case Multiplication::automatic: return "automatic";
+    }
+    return "";
+}
+
+
+TEST_CASE("Arithmetic of big unsigned integers", "[bigint]") {
+    const auto x = BigUInt::from_hex("ffffffffffffffffffffffffffffffff");
+    REQUIRE(x.limbs() == Limbs({~0ULL, ~0ULL}));
+    REQUIRE(x.to_hex() == "ffffffffffffffffffffffffffffffff");
+    REQUIRE(x.bits() == 128);
+    REQUIRE(x + 1 == BigUInt(1) << 128);
+    REQUIRE((x + 1) - 1 == x);
+    REQUIRE(x * x == (BigUInt(1) << 256) - (BigUInt(1) << 129) + 1);
+    REQUIRE((x >> 64) == BigUInt(~0ULL));
+    REQUIRE(BigUInt(0).to_hex() == "0");
+    REQUIRE(BigUInt(0).bits() == 0);
+    REQUIRE(BigUInt::from_hex("00DEADbeef").to_hex() == "deadbeef");
+    REQUIRE(BigUInt(3) < BigUInt(1) << 64);
+
+    uint64_t rem = 0;
+    REQUIRE(divide(Limbs({0, 1}), 3, &rem) == Limbs({0x5555555555555555}));
+    REQUIRE(rem == 1);
+}
+
+TEST_CASE("All multiplication algorithms agree", "[bigint]") {
+    std::mt19937_64 gen(43);
+    const uint64_t p = 1000000007;
+
+    for (size_t n : {0, 1, 2, 3, 5, 8, 13, 31, 32, 33, 100, 200, 333}) {
+        for (size_t m : {n, n / 2 + 1, n + 7}) {
+            const Limbs a = random_limbs(gen, n);
+            const Limbs b = random_limbs(gen, m);
+            const Limbs expected = mul_schoolbook(a, b);
+            REQUIRE(mod(expected, p)
+                == (unsigned __int128)(mod(a, p)) * mod(b, p) % p);
+            for (auto algorithm : ALGORITHMS) {
+                INFO(name(algorithm) << " " << n << " x " << m);
+                REQUIRE(multiply(a, b, algorithm) == expected);
+            }
+        }
+    }
+
+    // maximal carries
+    for (size_t n : {4, 64, 300}) {
+        const Limbs ones(n, ~0ULL);
+        const Limbs expected = mul_schoolbook(ones, ones);
+        for (auto algorithm : ALGORITHMS) {
+            INFO(name(algorithm) << " " << n);
+            REQUIRE(multiply(ones, ones, algorithm) == expected);
+        }
+    }
+}
+
+TEST_CASE("Schönhage-Strassen for large operands", "[bigint]") {
+    std::mt19937_64 gen(44);
+    for (size_t n : {1000, 2500}) {
+        const Limbs a = random_limbs(gen, n);
+        const Limbs b = random_limbs(gen, n);
+        REQUIRE(mul_schonhage_strassen(a, b) == mul_toom3(a, b));
+    }
+}
+
+TEST_CASE("Fixed width unsigned integers", "[bigint]") {
+    using U256 = UInt<4>;
+
+    std::array<uint8_t, 32> bytes;
+    for (int i = 0; i < 32; ++i) {
+        bytes[i] = static_cast<uint8_t>(7 * i + 1);
+    }
+    const U256 x = U256::from_bytes(bytes);
+    REQUIRE(x.to_bytes() == bytes);
+    REQUIRE(x[0] == 0x322b241d160f0801);
+
+    const U256 y = U256(BigUInt::from_hex(
+        "8000000000000000000000000000000000000000000000000000000000000001"));
+    const BigUInt product = x.to_big() * y.to_big();
+    for (auto algorithm : ALGORITHMS) {
+        REQUIRE(mul_wide(x, y, algorithm).to_big() == product);
+    }
+    REQUIRE((x * y).to_big() == BigUInt(low_bits(product.limbs(), 256)));
+
+    const U256 max = U256(0) - U256(1);
+    REQUIRE(max + U256(1) == U256(0));
+    REQUIRE(max * max == U256(1));
+    REQUIRE(U256(1) < max);
+    REQUIRE(!(max < max));
+}
+
+
+// ./bigint [benchmark]
+//
+// Every algorithm runs only at the top level, the products it needs are
+// computed with the automatic choice.
+TEST_CASE("Multiplication throughput", "[.][benchmark]") {
+    std::mt19937_64 gen(42);
+    for (size_t n = 4; n <= 16384; n *= 2) {
+        const Limbs a = random_limbs(gen, n);
+        const Limbs b = random_limbs(gen, n);
+        const Limbs expected = multiply(a, b);
+
+        std::cout << std::setw(6) << n << " limbs:";
+        for (auto algorithm : ALGORITHMS) {
+            if (algorithm == Multiplication::schoolbook && n > 4096) {
+                std::cout << std::setw(14) << "-";
+                continue;
+            }
+            const int reps = std::max<int>(3, 1000000 / (n * n));
+            Limbs r;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < reps; ++i) {
+                r = multiply(a, b, algorithm);
+            }
+            auto end = std::chrono::steady_clock::now();
+            std::chrono::duration<double> elapsed = end - start;
+            REQUIRE(r == expected);
+            std::cout << std::setw(14) << std::fixed << std::setprecision(2)
+                << elapsed.count() / reps * 1e6;
+        }
+        std::cout << " us (schoolbook, Karatsuba, Toom-3, SSA, automatic)"
+            << std::endl;
+    }
+
+    // 256-bit operands, cf. README
+    using U256 = UInt<4>;
+    U256 x = U256::from_bytes({{1, 2, 3}});
+    U256 y = U256(BigUInt(random_limbs(gen, 4)));
+    const int reps = 1000000;
+    uint64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i) {
+        checksum += mul_wide(x, y)[5];
+        x = x + y;
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    std::cout << "256 x 256 bits, fixed width: " << elapsed.count() / reps * 1e9
+        << " ns" << std::endl;
+    REQUIRE(checksum != 0);
+}
@@ -0,0 +1,721 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <string>
+#include <ostream>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <assert.h>
+
+//
+// Unsigned integers of arbitrary and of fixed width
+//
+// Numbers are little-endian vectors of 64-bit limbs without leading zero
+// limbs, so zero is the empty vector. Multiplication comes in four flavors:
+//
+//   schoolbook            O(n^2)
+//   Karatsuba             O(n^1.585), 3 half-size products instead of 4
+//   Toom-Cook 3-way       O(n^1.465), 5 third-size products instead of 9
+//   Schönhage-Strassen    O(n log n log log n), FFT over Z/(2^N + 1)
+//
+// multiply() picks one by the size of the smaller operand. The thresholds
+// are the crossovers measured by the benchmark in bigint.cpp with -O2. Since
+// every recursion level allocates its vectors, Karatsuba only pays off from
+// about 100 limbs (6400 bits) on; for 256-bit operands UInt<4> multiplies
+// the arrays directly.
+//
+// Cf. D. E. Knuth, TAOCP Vol. 2, 4.3.3, and R. P. Brent, P. Zimmermann,
+// "Modern Computer Arithmetic", 2010, chapter 1 and 2.3.
+//
+
+using Limbs = std::vector<uint64_t>;
+
+// in limbs of the smaller operand
+constexpr size_t KARATSUBA_THRESHOLD = 96;
+constexpr size_t TOOM3_THRESHOLD = 768;
+constexpr size_t SCHONHAGE_STRASSEN_THRESHOLD = 8192;
+
+enum class Multiplication {
+    automatic,
+    schoolbook,
+    karatsuba,
+    toom3,
+    schonhage_strassen,
+};
+
+inline Limbs multiply(const Limbs& a, const Limbs& b,
+    Multiplication algorithm = Multiplication::automatic);
+
+
+//
+// Limb arithmetic
+//
+
+inline void trim(Limbs& a) {
+    while (!a.empty() && a.back() == 0) {
+        a.pop_back();
+    }
+}
+
+inline int compare(const Limbs& a, const Limbs& b) {
+    if (a.size() != b.size()) {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    for (size_t i = a.size(); i-- > 0; ) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+inline Limbs add(const Limbs& a, const Limbs& b) {
+    const Limbs& x = a.size() >= b.size() ? a : b;
+    const Limbs& y = a.size() >= b.size() ? b : a;
+    Limbs r(x.size() + 1);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        const unsigned __int128 s =
+            static_cast<unsigned __int128>(x[i]) + (i < y.size() ? y[i] : 0) + carry;
+        r[i] = static_cast<uint64_t>(s);
+        carry = static_cast<uint64_t>(s >> 64);
+    }
+    r.back() = carry;
+    trim(r);
+    return r;
+}
+
+// a - b for a >= b
+inline Limbs sub(const Limbs& a, const Limbs& b) {
+    assert(compare(a, b) >= 0);
+    Limbs r(a.size());
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        const uint64_t y = i < b.size() ? b[i] : 0;
+        const uint64_t d = a[i] - y - borrow;
+        borrow = (a[i] < y) || (a[i] - y < borrow);
+        r[i] = d;
+    }
+    assert(borrow == 0);
+    trim(r);
+    return r;
+}
+
+// r += a * 2^(64 offset)
+inline void add_to(Limbs& r, const Limbs& a, size_t offset = 0) {
+    if (a.empty()) {
+        return;
+    }
+    if (r.size() < offset + a.size() + 1) {
+        r.resize(offset + a.size() + 1, 0);
+    }
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < a.size(); ++i) {
+        const unsigned __int128 s =
+            static_cast<unsigned __int128>(r[offset + i]) + a[i] + carry;
+        r[offset + i] = static_cast<uint64_t>(s);
+        carry = static_cast<uint64_t>(s >> 64);
+    }
+    for (size_t j = offset + i; carry != 0; ++j) {
+        if (j == r.size()) {
+            r.push_back(0);
+        }
+        r[j] += carry;
+        carry = r[j] == 0;
+    }
+    trim(r);
+}
+
+inline Limbs shift_left(const Limbs& a, size_t bits) {
+    if (a.empty()) {
+        return a;
+    }
+    const size_t limbs = bits / 64;
+    const int s = bits % 64;
+    Limbs r(a.size() + limbs + 1, 0);
+    for (size_t i = 0; i < a.size(); ++i) {
+        r[i + limbs] |= a[i] << s;
+        if (s != 0) {
+            r[i + limbs + 1] = a[i] >> (64 - s);
+        }
+    }
+    trim(r);
+    return r;
+}
+
+inline Limbs shift_right(const Limbs& a, size_t bits) {
+    const size_t limbs = bits / 64;
+    const int s = bits % 64;
+    if (limbs >= a.size()) {
+        return {};
+    }
+    Limbs r(a.size() - limbs);
+    for (size_t i = 0; i < r.size(); ++i) {
+        r[i] = a[i + limbs] >> s;
+        if (s != 0 && i + limbs + 1 < a.size()) {
+            r[i] |= a[i + limbs + 1] << (64 - s);
+        }
+    }
+    trim(r);
+    return r;
+}
+
+// a mod 2^bits
+inline Limbs low_bits(const Limbs& a, size_t bits) {
+    const size_t limbs = (bits + 63) / 64;
+    Limbs r(a.begin(), a.begin() + std::min(limbs, a.size()));
+    if (bits % 64 != 0 && r.size() == limbs) {
+        r.back() &= (uint64_t(1) << (bits % 64)) - 1;
+    }
+    trim(r);
+    return r;
+}
+
+// limbs [begin, end) of a
+inline Limbs slice(const Limbs& a, size_t begin, size_t end) {
+    begin = std::min(begin, a.size());
+    end = std::min(end, a.size());
+    Limbs r(a.begin() + begin, a.begin() + end);
+    trim(r);
+    return r;
+}
+
+// quotient of a divided by d, the remainder is stored in rem
+inline Limbs divide(const Limbs& a, uint64_t d, uint64_t* rem = nullptr) {
+    assert(d != 0);
+    Limbs q(a.size());
+    unsigned __int128 r = 0;
+    for (size_t i = a.size(); i-- > 0; ) {
+        r = (r << 64) | a[i];
+        q[i] = static_cast<uint64_t>(r / d);
+        r %= d;
+    }
+    if (rem != nullptr) {
+        *rem = static_cast<uint64_t>(r);
+    }
+    trim(q);
+    return q;
+}
+
+
+//
+// Multiplication
+//
+
+inline Limbs mul_schoolbook(const Limbs& a, const Limbs& b) {
+    if (a.empty() || b.empty()) {
+        return {};
+    }
+    Limbs r(a.size() + b.size(), 0);
+    for (size_t i = 0; i < a.size(); ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < b.size(); ++j) {
+            const unsigned __int128 t =
+                static_cast<unsigned __int128>(a[i]) * b[j] + r[i + j] + carry;
+            r[i + j] = static_cast<uint64_t>(t);
+            carry = static_cast<uint64_t>(t >> 64);
+        }
+        r[i + b.size()] = carry;
+    }
+    trim(r);
+    return r;
+}
+
+// a b = z2 B^2m + ((a0 + a1)(b0 + b1) - z0 - z2) B^m + z0
+// with z0 = a0 b0, z2 = a1 b1 and B = 2^64
+inline Limbs mul_karatsuba(const Limbs& a, const Limbs& b) {
+    const size_t m = (std::max(a.size(), b.size()) + 1) / 2;
+    if (std::min(a.size(), b.size()) <= m || m < 2) {
+        return mul_schoolbook(a, b);
+    }
+
+    const Limbs a0 = slice(a, 0, m), a1 = slice(a, m, a.size());
+    const Limbs b0 = slice(b, 0, m), b1 = slice(b, m, b.size());
+    const Limbs z0 = multiply(a0, b0);
+    const Limbs z2 = multiply(a1, b1);
+    const Limbs z1 = sub(sub(multiply(add(a0, a1), add(b0, b1)), z0), z2);
+
+    Limbs r = z0;
+    add_to(r, z1, m);
+    add_to(r, z2, 2 * m);
+    return r;
+}
+
+
+// sign and magnitude, for the intermediate values of Toom-Cook
+struct SignedLimbs {
+    bool negative;
+    Limbs magnitude;
+};
+
+inline SignedLimbs signed_add(const SignedLimbs& x, const SignedLimbs& y) {
+    if (x.negative == y.negative) {
+        return {x.negative, add(x.magnitude, y.magnitude)};
+    }
+    if (compare(x.magnitude, y.magnitude) >= 0) {
+        Limbs m = sub(x.magnitude, y.magnitude);
+        return {x.negative && !m.empty(), m};
+    }
+    return {y.negative, sub(y.magnitude, x.magnitude)};
+}
+
+inline SignedLimbs signed_sub(const SignedLimbs& x, const SignedLimbs& y) {
+    return signed_add(x, {!y.negative && !y.magnitude.empty(), y.magnitude});
+}
+
+inline SignedLimbs signed_mul(const SignedLimbs& x, const SignedLimbs& y) {
+    Limbs m = multiply(x.magnitude, y.magnitude);
+    return {x.negative != y.negative && !m.empty(), m};
+}
+
+inline SignedLimbs signed_shl(const SignedLimbs& x, size_t bits) {
+    return {x.negative, shift_left(x.magnitude, bits)};
+}
+
+// exact division
+inline SignedLimbs signed_div(const SignedLimbs& x, uint64_t d) {
+    uint64_t rem = 0;
+    Limbs q = divide(x.magnitude, d, &rem);
+    assert(rem == 0);
+    return {x.negative && !q.empty(), q};
+}
+
+// a and b are split into three parts, i.e. read as polynomials of degree 2
+// in x = B^k. Their product of degree 4 is evaluated at 0, 1, -1, -2 and
+// infinity by 5 recursive multiplications and interpolated with the
+// sequence of M. Bodrato, "Towards Optimal Toom-Cook Multiplication for
+// Univariate and Multivariate Polynomials in Characteristic 2 and 0", 2007.
+inline Limbs mul_toom3(const Limbs& a, const Limbs& b) {
+    using S = SignedLimbs;
+
+    const size_t k = (std::max(a.size(), b.size()) + 2) / 3;
+    if (std::min(a.size(), b.size()) <= 2 * k || k < 2) {
+        return mul_karatsuba(a, b);
+    }
+
+    auto evaluate = [k](const Limbs& u) {
+        const S u0{false, slice(u, 0, k)};
+        const S u1{false, slice(u, k, 2 * k)};
+        const S u2{false, slice(u, 2 * k, u.size())};
+        const S t = signed_add(u0, u2);
+        return std::array<S, 5>{
+            u0,                                           // 0
+            signed_add(t, u1),                            // 1
+            signed_sub(t, u1),                            // -1
+            signed_add(signed_sub(u0, signed_shl(u1, 1)),
+                signed_shl(u2, 2)),                       // -2
+            u2,                                           // infinity
+        };
+    };
+    const auto p = evaluate(a);
+    const auto q = evaluate(b);
+
+    const S r_0 = signed_mul(p[0], q[0]);
+    const S r_1 = signed_mul(p[1], q[1]);
+    const S r_m1 = signed_mul(p[2], q[2]);
+    const S r_m2 = signed_mul(p[3], q[3]);
+    const S r_inf = signed_mul(p[4], q[4]);
+
+    S r3 = signed_div(signed_sub(r_m2, r_1), 3);
+    S r1 = signed_div(signed_sub(r_1, r_m1), 2);
+    S r2 = signed_sub(r_m1, r_0);
+    r3 = signed_add(signed_div(signed_sub(r2, r3), 2), signed_shl(r_inf, 1));
+    r2 = signed_sub(signed_add(r2, r1), r_inf);
+    r1 = signed_sub(r1, r3);
+
+    // the coefficients of the product are non-negative
+    Limbs r;
+    const S* coeffs[] = {&r_0, &r1, &r2, &r3, &r_inf};
+    for (size_t i = 0; i < 5; ++i) {
+        assert(!coeffs[i]->negative);
+        add_to(r, coeffs[i]->magnitude, i * k);
+    }
+    return r;
+}
+
+
+// Arithmetic in Z/(2^n + 1), where 2 is a root of unity of order 2n, so that
+// multiplications by powers of roots of unity are shifts.
+class FermatRing {
+public:
+    explicit FermatRing(size_t n)
+        : n_(n), p_(add(shift_left({1}, n), {1}))
+    {}
+
+    size_t bits() const { return n_; }
+
+    // for x < 2^(2n) + 2^n
+    Limbs reduce(const Limbs& x) const {
+        // x = hi 2^n + lo = lo - hi
+        const Limbs lo = low_bits(x, n_);
+        const Limbs hi = shift_right(x, n_);
+        return compare(lo, hi) >= 0 ? sub(lo, hi) : sub(add(lo, p_), hi);
+    }
+
+    Limbs add_mod(const Limbs& x, const Limbs& y) const {
+        Limbs s = add(x, y);
+        return compare(s, p_) >= 0 ? sub(s, p_) : s;
+    }
+
+    Limbs sub_mod(const Limbs& x, const Limbs& y) const {
+        return compare(x, y) >= 0 ? sub(x, y) : sub(add(x, p_), y);
+    }
+
+    Limbs neg(const Limbs& x) const { return x.empty() ? x : sub(p_, x); }
+
+    // x 2^s
+    Limbs mul_pow2(const Limbs& x, size_t s) const {
+        s %= 2 * n_;
+        if (s >= n_) {
+            return neg(mul_pow2(x, s - n_));
+        }
+        return reduce(shift_left(x, s));
+    }
+
+    Limbs mul(const Limbs& x, const Limbs& y) const {
+        return reduce(multiply(x, y));
+    }
+
+    // in-place FFT of length v.size() (a power of 2) with root of unity
+    // 2^e, iterative Cooley-Tukey
+    void fft(std::vector<Limbs>& v, size_t e) const {
+        const size_t len = v.size();
+        for (size_t i = 1, j = 0; i < len; ++i) {
+            size_t bit = len >> 1;
+            for (; j & bit; bit >>= 1) {
+                j ^= bit;
+            }
+            j ^= bit;
+            if (i < j) {
+                std::swap(v[i], v[j]);
+            }
+        }
+        for (size_t half = 1; half < len; half *= 2) {
+            // root of unity of order 2 half
+            const size_t step = e * (len / (2 * half));
+            for (size_t i = 0; i < len; i += 2 * half) {
+                for (size_t j = 0; j < half; ++j) {
+                    const Limbs u = v[i + j];
+                    const Limbs t = mul_pow2(v[i + j + half], step * j);
+                    v[i + j] = add_mod(u, t);
+                    v[i + j + half] = sub_mod(u, t);
+                }
+            }
+        }
+    }
+
+private:
+    size_t n_;
+    Limbs p_;  // 2^n + 1
+};
+
+// a and b are cut into pieces of m limbs, which are the coefficients of
+// polynomials of degree < K/2. Their product is a cyclic convolution of
+// length K, computed by FFT in Z/(2^n + 1) with n large enough to hold the
+// coefficients of the product. The K pointwise products of n-bit numbers
+// are recursive multiplications.
+//
+// Cf. A. Schönhage, V. Strassen, "Schnelle Multiplikation großer Zahlen",
+// 1971.
+inline Limbs mul_schonhage_strassen(const Limbs& a, const Limbs& b) {
+    const size_t size = std::max(a.size(), b.size());
+    if (std::min(a.size(), b.size()) < 8) {
+        return mul_toom3(a, b);
+    }
+
+    // K = 2^k pieces, choose k by a rough estimate of the cost
+    auto parameters = [size](size_t k) {
+        const size_t K = size_t(1) << k;
+        const size_t m = (size + K / 2 - 1) / (K / 2);
+        const size_t align = std::max<size_t>(64, K / 2);  // K | 2n
+        const size_t n = (128 * m + k + 1 + align - 1) / align * align;
+        return std::make_pair(m, n);
+    };
+    size_t k = 2;
+    double best = -1;
+    for (size_t j = 2; j < 24 && (size_t(1) << (j - 1)) <= size; ++j) {
+        const double limbs = parameters(j).second / 64.0 + 1;
+        const double cost = (size_t(1) << j) * (std::pow(limbs, 1.5) + 3.0 * j * limbs);
+        if (best < 0 || cost < best) {
+            best = cost;
+            k = j;
+        }
+    }
+    const size_t K = size_t(1) << k;
+    const size_t m = parameters(k).first;
+    const size_t n = parameters(k).second;
+    const FermatRing ring(n);
+
+    std::vector<Limbs> u(K), v(K);
+    for (size_t i = 0; i < K / 2; ++i) {
+        u[i] = slice(a, i * m, (i + 1) * m);
+        v[i] = slice(b, i * m, (i + 1) * m);
+    }
+
+    // root of unity of order K is 2^(2n/K)
+    const size_t e = 2 * n / K;
+    ring.fft(u, e);
+    ring.fft(v, e);
+    for (size_t i = 0; i < K; ++i) {
+        u[i] = ring.mul(u[i], v[i]);
+    }
+    ring.fft(u, 2 * n - e);
+
+    // divide by K = 2^k
+    Limbs r;
+    for (size_t i = 0; i < K; ++i) {
+        add_to(r, ring.mul_pow2(u[i], 2 * n - k), i * m);
+    }
+    return r;
+}
+
+inline Limbs multiply(const Limbs& a, const Limbs& b, Multiplication algorithm) {
+    switch (algorithm) {
+    case Multiplication::schoolbook:
+        return mul_schoolbook(a, b);
+    case Multiplication::karatsuba:
+        return mul_karatsuba(a, b);
+    case Multiplication::toom3:
+        return mul_toom3(a, b);
+    case Multiplication::schonhage_strassen:
+        return mul_schonhage_strassen(a, b);
+    case Multiplication::automatic:
+        break;
+    }
+
+    const Limbs& x = a.size() >= b.size() ? a : b;
+    const Limbs& y = a.size() >= b.size() ? b : a;
+    const size_t n = y.size();
+    if (n < KARATSUBA_THRESHOLD) {
+        return mul_schoolbook(x, y);
+    }
+
+    // unbalanced: multiply y by pieces of x of the same size
+    if (x.size() >= 2 * n) {
+        Limbs r;
+        for (size_t i = 0; i < x.size(); i += n) {
+            add_to(r, multiply(slice(x, i, i + n), y), i);
+        }
+        return r;
+    }
+
+    if (n < TOOM3_THRESHOLD) {
+        return mul_karatsuba(x, y);
+    } else if (n < SCHONHAGE_STRASSEN_THRESHOLD) {
+        return mul_toom3(x, y);
+    }
+    return mul_schonhage_strassen(x, y);
+}
+
+
+//
+// Arbitrary width
+//
+
+class BigUInt {
+public:
+    BigUInt() {}
+    BigUInt(uint64_t x) : limbs_{x} { trim(limbs_); }
+    explicit BigUInt(Limbs limbs) : limbs_(std::move(limbs)) { trim(limbs_); }
+
+    static BigUInt from_hex(const std::string& s) {
+        Limbs limbs((s.size() + 15) / 16, 0);
+        for (size_t i = 0; i < s.size(); ++i) {
+            const char c = s[s.size() - 1 - i];
+            const uint64_t d = c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10;
+            assert(d < 16);
+            limbs[i / 16] |= d << (4 * (i % 16));
+        }
+        return BigUInt(std::move(limbs));
+    }
+
+    std::string to_hex() const {
+        if (limbs_.empty()) {
+            return "0";
+        }
+        static const char* digits = "0123456789abcdef";
+        std::string s;
+        for (size_t i = 0; i < 16 * limbs_.size(); ++i) {
+            s.push_back(digits[(limbs_[i / 16] >> (4 * (i % 16))) & 0xF]);
+        }
+        while (s.size() > 1 && s.back() == '0') {
+            s.pop_back();
+        }
+        return std::string(s.rbegin(), s.rend());
+    }
+
+    const Limbs& limbs() const { return limbs_; }
+    bool is_zero() const { return limbs_.empty(); }
+
+    size_t bits() const {
+        return limbs_.empty()
+            ? 0
+            : 64 * limbs_.size() - __builtin_clzll(limbs_.back());
+    }
+
+    friend BigUInt operator+(const BigUInt& x, const BigUInt& y) {
+        return BigUInt(add(x.limbs_, y.limbs_));
+    }
+
+    // x - y for x >= y
+    friend BigUInt operator-(const BigUInt& x, const BigUInt& y) {
+        return BigUInt(sub(x.limbs_, y.limbs_));
+    }
+
+    friend BigUInt operator*(const BigUInt& x, const BigUInt& y) {
+        return BigUInt(multiply(x.limbs_, y.limbs_));
+    }
+
+    friend BigUInt operator<<(const BigUInt& x, size_t bits) {
+        return BigUInt(shift_left(x.limbs_, bits));
+    }
+
+    friend BigUInt operator>>(const BigUInt& x, size_t bits) {
+        return BigUInt(shift_right(x.limbs_, bits));
+    }
+
+    friend bool operator==(const BigUInt& x, const BigUInt& y) {
+        return x.limbs_ == y.limbs_;
+    }
+
+    friend bool operator<(const BigUInt& x, const BigUInt& y) {
+        return compare(x.limbs_, y.limbs_) < 0;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const BigUInt& x) {
+        return os << "0x" << x.to_hex();
+    }
+
+private:
+    Limbs limbs_;
+};
+
+
+//
+// Fixed width of N limbs, arithmetic modulo 2^(64 N)
+//
+
+template<size_t N>
+class UInt {
+public:
+    static constexpr size_t BYTES = 8 * N;
+
+    UInt() : limbs_{} {}
+    UInt(uint64_t x) : limbs_{} { limbs_[0] = x; }
+    explicit UInt(const std::array<uint64_t, N>& limbs) : limbs_(limbs) {}
+    // the lowest N limbs
+    explicit UInt(const BigUInt& x) : limbs_{} {
+        const auto& limbs = x.limbs();
+        std::copy(limbs.begin(), limbs.begin() + std::min(N, limbs.size()),
+            limbs_.begin());
+    }
+
+    // little-endian, e.g. UInt<4> from char[32]
+    static UInt from_bytes(const std::array<uint8_t, BYTES>& s) {
+        UInt x;
+        for (size_t i = 0; i < BYTES; ++i) {
+            x.limbs_[i / 8] |= uint64_t(s[i]) << (8 * (i % 8));
+        }
+        return x;
+    }
+
+    std::array<uint8_t, BYTES> to_bytes() const {
+        std::array<uint8_t, BYTES> s;
+        for (size_t i = 0; i < BYTES; ++i) {
+            s[i] = static_cast<uint8_t>(limbs_[i / 8] >> (8 * (i % 8)));
+        }
+        return s;
+    }
+
+    BigUInt to_big() const {
+        return BigUInt(Limbs(limbs_.begin(), limbs_.end()));
+    }
+
+    uint64_t operator[](size_t i) const { return limbs_[i]; }
+
+    friend UInt operator+(const UInt& x, const UInt& y) {
+        UInt r;
+        uint64_t carry = 0;
+        for (size_t i = 0; i < N; ++i) {
+            const unsigned __int128 s =
+                static_cast<unsigned __int128>(x.limbs_[i]) + y.limbs_[i] + carry;
+            r.limbs_[i] = static_cast<uint64_t>(s);
+            carry = static_cast<uint64_t>(s >> 64);
+        }
+        return r;
+    }
+
+    friend UInt operator-(const UInt& x, const UInt& y) {
+        UInt r;
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < N; ++i) {
+            const uint64_t a = x.limbs_[i], b = y.limbs_[i];
+            r.limbs_[i] = a - b - borrow;
+            borrow = (a < b) || (a - b < borrow);
+        }
+        return r;
+    }
+
+    // product modulo 2^(64 N)
+    friend UInt operator*(const UInt& x, const UInt& y) {
+        UInt r;
+        for (size_t i = 0; i < N; ++i) {
+            uint64_t carry = 0;
+            for (size_t j = 0; i + j < N; ++j) {
+                const unsigned __int128 t =
+                    static_cast<unsigned __int128>(x.limbs_[i]) * y.limbs_[j]
+                    + r.limbs_[i + j] + carry;
+                r.limbs_[i + j] = static_cast<uint64_t>(t);
+                carry = static_cast<uint64_t>(t >> 64);
+            }
+        }
+        return r;
+    }
+
+    // full product. Below the Karatsuba threshold schoolbook on the arrays
+    // without any allocation, the given algorithm otherwise.
+    friend UInt<2 * N> mul_wide(const UInt& x, const UInt& y,
+        Multiplication algorithm = Multiplication::automatic)
+    {
+        if (algorithm == Multiplication::automatic && N < KARATSUBA_THRESHOLD) {
+            std::array<uint64_t, 2 * N> r{};
+            for (size_t i = 0; i < N; ++i) {
+                uint64_t carry = 0;
+                for (size_t j = 0; j < N; ++j) {
+                    const unsigned __int128 t =
+                        static_cast<unsigned __int128>(x.limbs_[i]) * y.limbs_[j]
+                        + r[i + j] + carry;
+                    r[i + j] = static_cast<uint64_t>(t);
+                    carry = static_cast<uint64_t>(t >> 64);
+                }
+                r[i + N] = carry;
+            }
+            return UInt<2 * N>(r);
+        }
+        return UInt<2 * N>(BigUInt(multiply(
+            Limbs(x.limbs_.begin(), x.limbs_.end()),
+            Limbs(y.limbs_.begin(), y.limbs_.end()),
+            algorithm)));
+    }
+
+    friend bool operator==(const UInt& x, const UInt& y) {
+        return x.limbs_ == y.limbs_;
+    }
+
+    friend bool operator<(const UInt& x, const UInt& y) {
+        return std::lexicographical_compare(x.limbs_.rbegin(), x.limbs_.rend(),
+            y.limbs_.rbegin(), y.limbs_.rend());
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const UInt& x) {
+        return os << x.to_big();
+    }
+
+private:
+    std::array<uint64_t, N> limbs_;
+};
@@ -1,121 +1,419 @@
 //
 // Conversion of grammar to CNF
 //
+// Symbols are interned: the passes work on dense integer ids, so that
+// lookups hash and compare integers instead of strings, and sets of symbols
+// can be flags indexed by id. Names are only needed to load and dump a
+// grammar, and to name new symbols. The passes change one grammar in place,
+// with the rules in flat vectors.
+//
 
 #include <catch.hpp>
 #include <vector>
-#include <unordered_set>
+#include <string>
+#include <algorithm>
+#include <initializer_list>
 #include <unordered_map>
 #include <assert.h>
+#include <random>
+#include <chrono>
+#include <iostream>
+
+
+class SymbolTable {
+public:
+    using Symbol = uint32_t;
+
+    // ε, the empty word, is "" and has id 0
+    SymbolTable() { intern(""); }
+
+    Symbol intern(const std::string& name) {
+        auto it = ids_.find(name);
+        if (it != ids_.end()) {
+            return it->second;
+        }
+        const auto s = static_cast<Symbol>(names_.size());
+        names_.push_back(name);
+        next_suffix_.push_back(0);
+        ids_.emplace(name, s);
+        return s;
+    }
+
+    // a new symbol, named name if it is unused, otherwise name0, name1, ...
+    Symbol fresh(const std::string& name) {
+        auto it = ids_.find(name);
+        if (it == ids_.end()) {
+            return intern(name);
+        }
+        std::string candidate;
+        do {
+            candidate = name + std::to_string(next_suffix_[it->second]++);
+        } while (ids_.count(candidate) > 0);
+        return intern(candidate);
+    }
+
+    const std::string& name(Symbol s) const { return names_[s]; }
+    size_t size() const { return names_.size(); }
+
+private:
+    std::vector<std::string> names_;
+    std::unordered_map<std::string, Symbol> ids_;
+    std::vector<size_t> next_suffix_;  // of the names of fresh symbols
+};
+
+
+// Rules in flat vectors
+//
+// Rule i is lhs(i) → rhs(i), and the right-hand sides are ranges of one
+// arena instead of a vector per rule. Rules are appended, changed in place
+// or removed, which keeps their order; the arena space of removed and
+// shortened rules is reclaimed once it is more than half of the arena.
+class Rules {
+public:
+    using Symbol = SymbolTable::Symbol;
+
+    // valid until the next change of the rules
+    class Rhs {
+    public:
+        Rhs(const Symbol* first, const Symbol* last)
+        : first_(first), last_(last) {}
+
+        const Symbol* begin() const { return first_; }
+        const Symbol* end() const { return last_; }
+        size_t size() const { return last_ - first_; }
+        bool empty() const { return first_ == last_; }
+        Symbol front() const { return *first_; }
+        Symbol operator[](size_t k) const { return first_[k]; }
+
+        bool operator==(const Rhs& rhs) const {
+            return std::equal(first_, last_, rhs.first_, rhs.last_);
+        }
+
+    private:
+        const Symbol* first_;
+        const Symbol* last_;
+    };
+
+    // as the value type of a multimap
+    struct Rule {
+        Symbol first;
+        Rhs second;
+    };
+
+    class const_iterator {
+    public:
+        const_iterator(const Rules* rules, size_t i) : rules_(rules), i_(i) {}
+        Rule operator*() const { return (*rules_)[i_]; }
+        const_iterator& operator++() { ++i_; return *this; }
+        bool operator!=(const const_iterator& it) const { return i_ != it.i_; }
+
+    private:
+        const Rules* rules_;
+        size_t i_;
+    };
+
+    size_t size() const { return lhs_.size(); }
+    Symbol lhs(size_t i) const { return lhs_[i]; }
+    Rhs rhs(size_t i) const {
+        return Rhs(arena_.data() + first_[i], arena_.data() + last_[i]);
+    }
+    Rule operator[](size_t i) const { return {lhs(i), rhs(i)}; }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    template<typename It>
+    void push_back(Symbol lhs, It first, It last) {
+        lhs_.push_back(lhs);
+        first_.push_back(arena_.size());
+        arena_.insert(arena_.end(), first, last);
+        last_.push_back(arena_.size());
+    }
+
+    // lhs → rhs(j), by index since the arena may move
+    void push_back_copy(Symbol lhs, size_t j) {
+        lhs_.push_back(lhs);
+        first_.push_back(arena_.size());
+        for (size_t k = first_[j]; k < last_[j]; ++k) {
+            arena_.push_back(arena_[k]);
+        }
+        last_.push_back(arena_.size());
+    }
+
+    void set(size_t i, size_t k, Symbol s) { arena_[first_[i] + k] = s; }
+    void truncate(size_t i, size_t n) {
+        garbage_ += last_[i] - first_[i] - n;
+        last_[i] = first_[i] + n;
+    }
+
+    // keeps the order of the others
+    void remove(const std::vector<char>& removed) {
+        size_t j = 0;
+        for (size_t i = 0; i < size(); ++i) {
+            if (removed[i]) {
+                garbage_ += last_[i] - first_[i];
+                continue;
+            }
+            lhs_[j] = lhs_[i];
+            first_[j] = first_[i];
+            last_[j] = last_[i];
+            j += 1;
+        }
+        lhs_.resize(j);
+        first_.resize(j);
+        last_.resize(j);
+        if (2 * garbage_ > arena_.size()) {
+            compact();
+        }
+    }
+
+private:
+    void compact() {
+        std::vector<Symbol> arena;
+        arena.reserve(arena_.size() - garbage_);
+        for (size_t i = 0; i < size(); ++i) {
+            const size_t first = arena.size();
+            arena.insert(arena.end(),
+                arena_.begin() + first_[i], arena_.begin() + last_[i]);
+            first_[i] = first;
+            last_[i] = arena.size();
+        }
+        arena_ = std::move(arena);
+        garbage_ = 0;
+    }
 
+    std::vector<Symbol> lhs_;
+    std::vector<size_t> first_, last_;  // rhs(i) is arena_[first_[i], last_[i])
+    std::vector<Symbol> arena_;
+    size_t garbage_ = 0;  // symbols in the arena which belong to no rule
+};
 
+
+// The passes change the rules through the grammar, which counts for every
+// symbol its rules and its occurrences on right-hand sides. So whether a
+// symbol is a terminal is known at any time, without rescanning the rules.
 struct Grammar {
-    using Symbol = std::string;
-    using Rule = std::pair<Symbol, std::vector<Symbol>>;
-    using Rules = std::unordered_multimap<Symbol, std::vector<Symbol>>;
+    using Symbol = SymbolTable::Symbol;
+    // by name, to load and dump grammars
+    using NamedRules =
+        std::unordered_multimap<std::string, std::vector<std::string>>;
+
+    static constexpr Symbol EPS = 0;
 
-    Grammar(Rules rules, Symbol start)
-    : rules(rules)
-    , S(start)
+    Grammar(const NamedRules& named_rules, const std::string& start)
+    : S(table.intern(start))
     {
-        for (const auto kv : rules) {
+        std::vector<Symbol> rhs;
+        for (const auto& kv : named_rules) {
+            rhs.clear();
             for (const auto& s : kv.second) {
-                symbols.insert(s);
-                if (rules.count(s) == 0) {
-                    terminals.insert(s);
-                }
+                rhs.push_back(table.intern(s));
             }
+            add_rule(table.intern(kv.first), rhs.begin(), rhs.end());
         }
     }
 
-    bool is_terminal(const Symbol& s) const {
-        return terminals.count(s) > 0;
+    // symbols on right-hand sides
+    bool is_symbol(Symbol s) const {
+        return s < rhs_count_.size() && rhs_count_[s] > 0;
+    }
+    // symbols on right-hand sides without rules
+    bool is_terminal(Symbol s) const {
+        return is_symbol(s) && lhs_count_[s] == 0;
+    }
+    size_t num_symbols() const { return num_symbols_; }
+    size_t num_terminals() const { return num_terminals_; }
+
+    const std::string& name(Symbol s) const { return table.name(s); }
+
+    NamedRules named_rules() const {
+        NamedRules res;
+        for (const auto rule : rules) {
+            std::vector<std::string> rhs;
+            rhs.reserve(rule.second.size());
+            for (auto s : rule.second) {
+                rhs.push_back(name(s));
+            }
+            res.emplace(name(rule.first), std::move(rhs));
+        }
+        return res;
+    }
+
+    template<typename It>
+    void add_rule(Symbol lhs, It first, It last) {
+        rules.push_back(lhs, first, last);
+        count_rule(rules.size() - 1, 1);
+    }
+
+    void add_rule(Symbol lhs, std::initializer_list<Symbol> rhs) {
+        add_rule(lhs, rhs.begin(), rhs.end());
+    }
+
+    // lhs → rhs of rule j
+    void copy_rule(Symbol lhs, size_t j) {
+        rules.push_back_copy(lhs, j);
+        count_rule(rules.size() - 1, 1);
     }
 
-    Rules rules;
+    // replaces the k-th symbol of rule i by s
+    void replace(size_t i, size_t k, Symbol s) {
+        count(rules.rhs(i)[k], 0, -1);
+        rules.set(i, k, s);
+        count(s, 0, 1);
+    }
+
+    // keeps the first n symbols of rule i
+    void truncate(size_t i, size_t n) {
+        for (size_t k = n; k < rules.rhs(i).size(); ++k) {
+            count(rules.rhs(i)[k], 0, -1);
+        }
+        rules.truncate(i, n);
+    }
+
+    // rule i is removed if removed[i]
+    void remove_rules(const std::vector<char>& removed) {
+        for (size_t i = 0; i < rules.size(); ++i) {
+            if (removed[i]) {
+                count_rule(i, -1);
+            }
+        }
+        rules.remove(removed);
+    }
+
+    // a copy of a grammar has its own table, so that passes on it do not
+    // change the original
+    SymbolTable table;
+    Rules rules;  // only changed by the functions above
     Symbol S;  // start symbol
-    std::unordered_set<Symbol> symbols;
-    std::unordered_set<Symbol> terminals;
+
+private:
+    void count_rule(size_t i, int d) {
+        count(rules.lhs(i), d, 0);
+        for (auto s : rules.rhs(i)) {
+            count(s, 0, d);
+        }
+    }
+
+    void count(Symbol s, int lhs_d, int rhs_d) {
+        if (s >= rhs_count_.size()) {
+            lhs_count_.resize(table.size(), 0);
+            rhs_count_.resize(table.size(), 0);
+        }
+        const bool symbol = is_symbol(s), terminal = is_terminal(s);
+        lhs_count_[s] += lhs_d;
+        rhs_count_[s] += rhs_d;
+        num_symbols_ += is_symbol(s) - symbol;
+        num_terminals_ += is_terminal(s) - terminal;
+    }
+
+    // by symbol: number of rules, and of occurrences on right-hand sides
+    std::vector<size_t> lhs_count_, rhs_count_;
+    size_t num_symbols_ = 0;
+    size_t num_terminals_ = 0;
 };
 
+constexpr Grammar::Symbol Grammar::EPS;
 
-bool rule_exists(const Grammar::Rules& rules, const Grammar::Rule& rule) {
-    auto range = rules.equal_range(rule.first);
-    for (auto it = range.first; it != range.second; ++it) {
-        if (it->second == rule.second) {
-            return true;
-            break;
+
+// Rules with the same lhs, as linked lists through the rule indices, e.g.
+// for the rules of the output so far while a pass runs through the grammar
+class RulesByLhs {
+public:
+    static constexpr size_t NONE = -1;
+
+    explicit RulesByLhs(const Grammar& gr)
+    : gr_(gr), head_(gr.table.size(), NONE) {}
+
+    void add(size_t i) {
+        const auto lhs = gr_.rules.lhs(i);
+        if (lhs >= head_.size()) {
+            head_.resize(gr_.table.size(), NONE);
         }
+        if (i >= next_.size()) {
+            next_.resize(gr_.rules.size(), NONE);
+        }
+        next_[i] = head_[lhs];
+        head_[lhs] = i;
     }
-    return false;
-}
 
+    size_t first(Grammar::Symbol lhs) const {
+        return lhs < head_.size() ? head_[lhs] : NONE;
+    }
+    size_t next(size_t i) const { return next_[i]; }
 
-// START
-Grammar cnf_start(const Grammar& gr) {
-    Grammar::Rules rules = gr.rules;
+    bool exists(Grammar::Symbol lhs, const Rules::Rhs& rhs) const {
+        for (size_t j = first(lhs); j != NONE; j = next(j)) {
+            if (gr_.rules.rhs(j) == rhs) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    const Grammar& gr_;
+    std::vector<size_t> head_, next_;
+};
+
+constexpr size_t RulesByLhs::NONE;
 
-    auto S = gr.S + "0";
-    assert(gr.symbols.count(S) == 0);
-    rules.insert(std::make_pair(S, std::vector<Grammar::Symbol>{gr.S}));
 
-    return Grammar(std::move(rules), std::move(S));
+// The passes take the grammar by value and change it in place, so that
+// cnf() moves one grammar through all of them.
+
+// START
+Grammar cnf_start(Grammar gr) {
+    const auto S = gr.table.fresh(gr.name(gr.S));
+    gr.add_rule(S, {gr.S});
+    gr.S = S;
+    return gr;
 }
 
 
 // TERM
-Grammar cnf_term(const Grammar& gr) {
-    Grammar::Rules rules;
-
-    for (const auto& rule : gr.rules) {
-        if (rule.second.size() < 2) {
-            // copy rule without changes
-            rules.insert(rule);
+Grammar cnf_term(Grammar gr) {
+    // N_s of terminal s, or EPS if there is none yet
+    std::vector<Grammar::Symbol> N(gr.table.size(), Grammar::EPS);
+
+    const size_t n = gr.rules.size();
+    for (size_t i = 0; i < n; ++i) {
+        const size_t len = gr.rules.rhs(i).size();
+        if (len < 2) {
             continue;
         }
 
-        // copy rules and replace all terminals s by new symbol N_s
-        auto it = rules.insert(rule);
-        for (auto& s : it->second) {
+        // replace all terminals s by new symbol N_s
+        for (size_t k = 0; k < len; ++k) {
+            const auto s = gr.rules.rhs(i)[k];
             if (gr.is_terminal(s)) {
-                Grammar::Symbol N_s = "N_" + s;
-                assert(gr.symbols.count(N_s) == 0);
-                if (rules.count(N_s) == 0) {
-                    rules.insert(std::make_pair(
-                        N_s, std::vector<Grammar::Symbol>{s}));
+                if (N[s] == Grammar::EPS) {
+                    N[s] = gr.table.fresh("N_" + gr.name(s));
+                    gr.add_rule(N[s], {s});
                 }
-                s = N_s;
+                gr.replace(i, k, N[s]);
             }
         }
     }
 
-    return Grammar(std::move(rules), gr.S);
+    return gr;
 }
 
 
 // BIN
-Grammar cnf_bin(const Grammar& gr) {
-    Grammar::Rules rules;
+Grammar cnf_bin(Grammar gr) {
+    std::vector<Grammar::Symbol> rhs;
 
-    for (const auto& rule : gr.rules) {
-        if (rule.second.size() < 3) {
-            rules.insert(rule);
+    const size_t n = gr.rules.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (gr.rules.rhs(i).size() < 3) {
             continue;
         }
 
         // We assume that TERM reduction was already done and all symbols in
         // the rule are non-terminal.
 
-        const Grammar::Symbol s = rule.first;
-        const auto& rhs = rule.second;
-
-        // find the first non-used consecutive name of s
-        size_t num = 0;
-        Grammar::Symbol si = s + std::to_string(num);
-        while (rules.count(si) > 0 || gr.symbols.count(si) > 0) {
-            num += 1;
-            si = s + std::to_string(num);
-        }
+        const Grammar::Symbol s = gr.rules.lhs(i);
+        rhs.assign(gr.rules.rhs(i).begin(), gr.rules.rhs(i).end());
 
         // A → X1 X2 ... Xn
         //
@@ -125,43 +423,30 @@ Grammar cnf_bin(const Grammar& gr) {
         // A1   → X2   A2,
         // ... ,
         // An-2 → Xn-1 Xn,
+        //
+        // where A1, A2, ... are the next unused names A0, A1, ..., and the
+        // first rule replaces the original one
 
-        si = s;
-        for (auto it = rhs.begin(); it != rhs.end() - 2; ++it)
+        Grammar::Symbol si = gr.table.fresh(gr.name(s));
+        gr.replace(i, 1, si);
+        gr.truncate(i, 2);
+        for (auto it = rhs.begin() + 1; it != rhs.end() - 2; ++it)
         {
-            auto si_next = s + std::to_string(num);
-
-            rules.insert(std::make_pair(si,
-                std::vector<Grammar::Symbol>{*it, si_next}));
+            const auto si_next = gr.table.fresh(gr.name(s));
+            gr.add_rule(si, {*it, si_next});
             si = si_next;
-            num += 1;
-        }
-        rules.insert(std::make_pair(
-            si,
-            std::vector<Grammar::Symbol>{*(rhs.end() - 2), *(rhs.end() - 1)}));
-    }
-    // for (const auto& rule : rules) {
-    //     auto range = rules.equal_range(rule.first);
-    //     bool exists = false;
-    //     for (auto it = range.first; it != range.second; ++it) {
-    //         if (it->second == rule.second) {
-    //             exists = true;
-    //             break;
-    //         }
-    //     }
-
-    //     if (!exists) {
-    //         rules.insert(rule);
-    //     }
-    // }
-
-    return Grammar(std::move(rules), gr.S);
+        }
+        gr.add_rule(si, {*(rhs.end() - 2), *(rhs.end() - 1)});
+    }
+
+    return gr;
 }
 
 
+// nullable is indexed by symbol
 std::vector<std::vector<Grammar::Symbol>> replace_nullable(
     const std::vector<Grammar::Symbol>& rhs,
-    const std::unordered_set<Grammar::Symbol> nullable)
+    const std::vector<char>& nullable)
 {
     if (rhs.empty()) {
         return {};
@@ -169,15 +454,15 @@ std::vector<std::vector<Grammar::Symbol>> replace_nullable(
 
     std::vector<std::vector<Grammar::Symbol>> result{rhs};
     for (auto i = rhs.begin(); i != rhs.end(); ++i) {
-        if (nullable.count(*i) > 0) {
+        if (nullable[*i]) {
             std::vector<Grammar::Symbol> new_rhs(rhs.begin(), i);
             for (auto j = i + 1; j != rhs.end(); ++j) {
                 new_rhs.push_back(*j);
             }
 
             auto rules = replace_nullable(new_rhs, nullable);
-            for (const auto rule : rules) {
-                result.push_back(rule);
+            for (auto& rule : rules) {
+                result.push_back(std::move(rule));
             }
         }
     }
@@ -186,107 +471,149 @@ std::vector<std::vector<Grammar::Symbol>> replace_nullable(
 
 
 // DEL
-Grammar cnf_del(const Grammar& gr) {
-    Grammar::Rules rules;
-
+Grammar cnf_del(Grammar gr) {
     // compute nullable symbols
-    std::unordered_set<Grammar::Symbol> nullable;
+    std::vector<char> nullable(gr.table.size(), false);
     size_t nullableSize = 0;
     while (true) {
-        for (const auto& rule : gr.rules) {
-            if (rule.second.size() == 1 && rule.second.front() == "") {
-                nullable.insert(rule.first);
-            } else {
-                bool isNullable = true;
-                for (const auto& s : rule.second) {
-                    if (nullable.count(s) == 0) {
+        size_t size = nullableSize;
+        for (const auto rule : gr.rules) {
+            if (nullable[rule.first]) {
+                continue;
+            }
+
+            bool isNullable = true;
+            if (rule.second.size() != 1 || rule.second.front() != Grammar::EPS) {
+                for (auto s : rule.second) {
+                    if (!nullable[s]) {
                         isNullable = false;
                         break;
                     }
                 }
+            }
 
-                if (isNullable) {
-                    nullable.insert(rule.first);
-                }
+            if (isNullable) {
+                nullable[rule.first] = true;
+                size += 1;
             }
         }
 
-        if (nullableSize == nullable.size()) {
+        if (nullableSize == size) {
             break;
         }
 
-        nullableSize = nullable.size();
+        nullableSize = size;
     }
 
-    // replace rules with nullable symbols
-    for (const auto& rule : gr.rules) {
-        for (const auto& rhs : replace_nullable(rule.second, nullable)) {
-            auto new_rule = std::make_pair(rule.first, rhs);
-            if (!rule_exists(rules, new_rule)) {
-                rules.insert(std::move(new_rule));
+    // replace rules with nullable symbols, the first variant is the rule
+    // itself, and duplicates are dropped
+    RulesByLhs output(gr);
+    const size_t n = gr.rules.size();
+    std::vector<char> removed(n, false);
+    std::vector<Grammar::Symbol> rhs;
+    for (size_t i = 0; i < n; ++i) {
+        const auto lhs = gr.rules.lhs(i);
+        rhs.assign(gr.rules.rhs(i).begin(), gr.rules.rhs(i).end());
+        const auto variants = replace_nullable(rhs, nullable);
+        removed[i] = variants.empty() || output.exists(lhs, gr.rules.rhs(i));
+        if (!removed[i]) {
+            output.add(i);
+        }
+        for (size_t v = 1; v < variants.size(); ++v) {
+            const Rules::Rhs variant(variants[v].data(),
+                variants[v].data() + variants[v].size());
+            if (!output.exists(lhs, variant)) {
+                gr.add_rule(lhs, variants[v].begin(), variants[v].end());
+                output.add(gr.rules.size() - 1);
             }
         }
     }
 
     // remove all rules with eps on the rhs
-    for (auto it = rules.begin(); it != rules.end();) {
-        if (it->first != gr.S &&
-            it->second.size() == 1 && it->second.front() == "")
+    removed.resize(gr.rules.size(), false);
+    for (size_t i = 0; i < gr.rules.size(); ++i) {
+        const auto rhs = gr.rules.rhs(i);
+        if (gr.rules.lhs(i) != gr.S &&
+            rhs.size() == 1 && rhs.front() == Grammar::EPS)
         {
-            it = rules.erase(it);
-        } else {
-            ++it;
+            removed[i] = true;
         }
     }
+    gr.remove_rules(removed);
 
-    return Grammar(std::move(rules), gr.S);
+    return gr;
 }
 
 
 
 // UNIT
-Grammar cnf_unit(const Grammar& gr) {
-    Grammar::Rules rules;
-    for (const auto& rule : gr.rules) {
-        if (rule.second.size() != 1 || gr.is_terminal(rule.second.front())) {
-            rules.insert(rule);
-            continue;
+Grammar cnf_unit(Grammar gr) {
+    // A → B with a nonterminal B
+    const size_t n = gr.rules.size();
+    std::vector<char> unit(n, false);
+    for (size_t i = 0; i < n; ++i) {
+        const auto rhs = gr.rules.rhs(i);
+        unit[i] = rhs.size() == 1 && !gr.is_terminal(rhs.front());
+    }
+
+    RulesByLhs input(gr), output(gr);
+    for (size_t i = 0; i < n; ++i) {
+        input.add(i);
+        if (!unit[i]) {
+            output.add(i);
         }
+    }
 
-        // rule: A → B
-        const auto& A = rule.first;
-        const auto& B = rule.second.front();
-        auto range = rules.equal_range(B);
-        for (auto it = range.first; it != range.second; ++it) {
-            rules.insert(std::make_pair(A, it->second));
+    // A → β for every B reachable from A by unit rules and every non-unit
+    // rule B → β, whatever the order of the rules
+    std::vector<char> done(gr.table.size(), false);
+    std::vector<size_t> seen(gr.table.size(), RulesByLhs::NONE);
+    std::vector<Grammar::Symbol> stack;
+    for (size_t i = 0; i < n; ++i) {
+        const auto A = gr.rules.lhs(i);
+        if (!unit[i] || done[A]) {
+            continue;
+        }
+        done[A] = true;
+
+        seen[A] = i;
+        stack.assign(1, A);
+        while (!stack.empty()) {
+            const auto B = stack.back();
+            stack.pop_back();
+            for (size_t j = input.first(B); j != RulesByLhs::NONE; j = input.next(j)) {
+                if (unit[j]) {
+                    const auto C = gr.rules.rhs(j).front();
+                    if (seen[C] != i) {
+                        seen[C] = i;
+                        stack.push_back(C);
+                    }
+                } else if (B != A && !output.exists(A, gr.rules.rhs(j))) {
+                    gr.copy_rule(A, j);
+                    output.add(gr.rules.size() - 1);
+                }
+            }
         }
     }
 
-    return Grammar(std::move(rules), gr.S);
+    unit.resize(gr.rules.size(), false);
+    gr.remove_rules(unit);
+
+    return gr;
 }
 
 
 // transform grammar to CNF (Chomsky Normal Form)
-Grammar cnf(const Grammar& gr) {
-
-    Grammar::Rules rules;
-    Grammar::Symbol S;
-
-    auto gr0 = cnf_start(gr);
-    auto gr1 = cnf_term(gr0);
-    auto gr2 = cnf_bin(gr1);
-    auto gr3 = cnf_del(gr2);
-    auto gr4 = cnf_unit(gr3);
-
-    return gr4;
+Grammar cnf(Grammar gr) {
+    return cnf_unit(cnf_del(cnf_bin(cnf_term(cnf_start(std::move(gr))))));
 }
 
 
 TEST_CASE("START: Eliminate the start symbol from right-handsides", "[CNF]") {
     Grammar gr({{"S", {"A"}}}, "S");
     auto gr0 = cnf_start(gr);
-    REQUIRE(gr0.S != "S");
-    REQUIRE(gr0.symbols.size() == 2);
+    REQUIRE(gr0.name(gr0.S) != "S");
+    REQUIRE(gr0.num_symbols() == 2);
 }
 
 TEST_CASE("TERM: Eliminate rules with non solitary terminals", "[CNF]") {
@@ -307,9 +634,7 @@ TEST_CASE("TERM: Eliminate rules with non solitary terminals", "[CNF]") {
         }
 
         for (auto s : rule.second) {
-            REQUIRE(
-                std::find(gr0.terminals.begin(), gr0.terminals.end(), s) ==
-                gr0.terminals.end());
+            REQUIRE(!gr0.is_terminal(s));
         }
     }
 }
@@ -334,9 +659,7 @@ TEST_CASE("BIN: Eliminate rhs with more than 2 non terminals", "[CNF]") {
 
         REQUIRE(rule.second.size() == 2);
         for (auto s : rule.second) {
-            REQUIRE(
-                std::find(gr0.terminals.begin(), gr0.terminals.end(), s) ==
-                gr0.terminals.end());
+            REQUIRE(!gr0.is_terminal(s));
         }
     }
 }
@@ -359,7 +682,7 @@ TEST_CASE("DEL: Eliminate ε-rules", "[CNF]") {
     REQUIRE(gr0.rules.size() == 12);
     for (auto rule : gr0.rules) {
         if (rule.first != gr0.S && rule.second.size() == 1) {
-            REQUIRE(rule.second.front() != "");
+            REQUIRE(gr0.name(rule.second.front()) != "");
         }
     }
 }
@@ -374,11 +697,126 @@ TEST_CASE("UNIT: Eliminate unit rules", "[CNF]") {
         },
         "S");
 
+    // S → C → A, so S and C get the rule of A
     auto gr0 = cnf_unit(gr);
-    REQUIRE(gr0.rules.size() == (gr.rules.size() - 1));
+    REQUIRE(gr0.named_rules() == Grammar::NamedRules({
+        {"S", {"t0", "t1", "t2"}},
+        {"S", {""}},
+        {"A", {"t0", "t1", "t2"}},
+        {"C", {""}},
+        {"C", {"t0", "t1", "t2"}},
+    }));
     for (auto rule : gr0.rules) {
         if (rule.second.size() == 1) {
             REQUIRE(gr0.is_terminal(rule.second.front()));
         }
     }
 }
+
+TEST_CASE("UNIT does not depend on the order of the rules", "[CNF]") {
+    for (bool unit_first : {true, false}) {
+        Grammar gr(Grammar::NamedRules{}, "S");
+        const auto A = gr.table.intern("A");
+        const auto a = gr.table.intern("a");
+        const auto b = gr.table.intern("b");
+        if (unit_first) {
+            gr.add_rule(gr.S, {A});
+            gr.add_rule(A, {a, b});
+        } else {
+            gr.add_rule(A, {a, b});
+            gr.add_rule(gr.S, {A});
+        }
+
+        REQUIRE(cnf(gr).named_rules() == Grammar::NamedRules({
+            {"S0", {"N_a", "N_b"}},
+            {"S", {"N_a", "N_b"}},
+            {"A", {"N_a", "N_b"}},
+            {"N_a", {"a"}},
+            {"N_b", {"b"}},
+        }));
+    }
+}
+
+TEST_CASE("Symbols are interned once and named on dump", "[CNF]") {
+    const Grammar::NamedRules named{
+        {"S", {"A", "b", "A"}},
+        {"A", {"a"}},
+        {"A", {""}},
+        {"A0", {"a"}},
+    };
+    Grammar gr(named, "S");
+    REQUIRE(gr.table.size() == 6);  // "", S, A, b, a, A0
+    REQUIRE(gr.name(Grammar::EPS) == "");
+    REQUIRE(gr.name(gr.S) == "S");
+    REQUIRE(gr.named_rules() == named);
+
+    // new names avoid the existing ones
+    REQUIRE(gr.name(gr.table.fresh("N_a")) == "N_a");
+    REQUIRE(gr.name(gr.table.fresh("A")) == "A1");
+    REQUIRE(gr.name(gr.table.fresh("A")) == "A2");
+    REQUIRE(gr.name(gr.table.fresh("A")) == "A3");
+
+    // passes on copies do not change the original
+    const size_t size = gr.table.size();
+    const auto first = cnf_start(gr);
+    const auto second = cnf_start(gr);
+    REQUIRE(first.name(first.S) == "S0");
+    REQUIRE(second.name(second.S) == "S0");
+    REQUIRE(gr.table.size() == size);
+
+    auto res = cnf(gr);
+    REQUIRE(gr.table.size() == size);
+    for (const auto& rule : res.named_rules()) {
+        REQUIRE(!rule.second.empty());
+        REQUIRE(rule.second.size() <= 2);
+        if (rule.second.size() == 2) {
+            REQUIRE(rule.second[0] != "a");
+            REQUIRE(rule.second[1] != "b");
+        }
+    }
+}
+
+// a random grammar over the nonterminals X0_, X1_, ... and the terminals
+// t0, ..., t99, with rules of length 1 to 5 and a few ε-rules; rules of
+// length 1 are terminal
+Grammar::NamedRules random_grammar(size_t num_rules, size_t num_nonterminals,
+    uint64_t seed)
+{
+    std::mt19937_64 gen(seed);
+    auto nonterminal = [&]() {
+        return "X" + std::to_string(gen() % num_nonterminals) + "_";
+    };
+    Grammar::NamedRules rules;
+    for (size_t i = 0; i < num_nonterminals; ++i) {
+        rules.emplace("X" + std::to_string(i) + "_",
+            std::vector<std::string>{"t" + std::to_string(gen() % 100)});
+    }
+    while (rules.size() < num_rules) {
+        std::vector<std::string> rhs;
+        if (gen() % 1000 == 0) {
+            rhs.push_back("");
+        } else {
+            const size_t k = 1 + gen() % 5;
+            for (size_t i = 0; i < k; ++i) {
+                // few unit rules, which UNIT multiplies
+                rhs.push_back(k == 1 || gen() % 10 < 3
+                    ? "t" + std::to_string(gen() % 100)
+                    : nonterminal());
+            }
+        }
+        rules.emplace(nonterminal(), std::move(rhs));
+    }
+    return rules;
+}
+
+TEST_CASE("CNF of large grammars", "[.][benchmark]") {
+    for (size_t num_rules : {10000, 50000, 200000}) {
+        Grammar gr(random_grammar(num_rules, num_rules / 10, 1), "X0_");
+        auto start = std::chrono::steady_clock::now();
+        const auto res = cnf(std::move(gr));
+        auto end = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed = end - start;
+        std::cout << num_rules << " rules: " << res.rules.size()
+            << " rules in CNF in " << elapsed.count() << " s" << std::endl;
+    }
+}
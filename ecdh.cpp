@@ -1,16 +1,23 @@
 #include "ecdh.h"
+#include "f25519.h"
+#include "shuffle.h"
 
 #include <catch.hpp>
 #include <ostream>
 #include <assert.h>
 #include <iostream>
 #include <random>
+#include <chrono>
+#include <vector>
+#include <limits>
+#include <thread>
+#include <algorithm>
 
 // Domain parameters of cryptographic system
 
-template<int p, int a, int b>
-struct DomainParams {
-    using Fp = PF<p>;
+template<typename F, int64_t a, int64_t b>
+struct CurveDomainParams {
+    using Fp = F;
     using E = EllipticCurve<Fp, a, b>;
     using Point = typename E::Point;
 
@@ -18,20 +25,48 @@ struct DomainParams {
     const uint64_t n;  // order of G i.e. smallest positive n s.t. nG = O
     const uint64_t h;  // h = 1/n * #E(Fp), positive integer by Lagrange
                        // should be small, i.e. h < 5, preferably, h = 1
+
+    // precomputed multiples of G, built once per domain
+    const typename E::FixedBase G_table{G};
 };
 
+template<int p, int a, int b>
+using DomainParams = CurveDomainParams<PF<p>, a, b>;
+
+// Domain parameters of a given curve: #E by baby-step giant-step and the
+// point of largest order among a few random ones as generator, so h = 1 if
+// E(Fp) is cyclic
+template<typename F, int64_t a, int64_t b>
+CurveDomainParams<F, a, b> make_domain_params(uint64_t seed = 1) {
+    using E = EllipticCurve<F, a, b>;
+    const uint64_t size = E::bsgs_size(seed);
+
+    std::mt19937_64 gen(seed);
+    typename E::Point G;
+    uint64_t n = 1;
+    for (int attempt = 0; attempt < 32 && n < size; ++attempt) {
+        const auto P = E::random_point(gen);
+        const uint64_t m = E::order(P, size);
+        if (m > n) {
+            G = P;
+            n = m;
+        }
+    }
+    return {G, n, size / n};
+}
+
 // Private key
 
 template<typename DomainParams>
 struct PrivateKey {
     explicit PrivateKey(const DomainParams& params) {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> distr(1, params.n - 1);
+        // seeding from the random device once per thread, not per key
+        thread_local std::mt19937_64 gen(std::random_device{}());
+        std::uniform_int_distribution<uint64_t> distr(1, params.n - 1);
         d = distr(gen);
     }
 
-    int d;  // integer from [1, n - 1], where n is from params
+    uint64_t d;  // integer from [1, n - 1], where n is from params
 };
 
 // Public key
@@ -41,16 +76,95 @@ struct PublicKey {
     using Point = typename DomainParams::E::Point;
 
     PublicKey(const DomainParams& params, const PrivateKey<DomainParams>& key)
-        : Q(key.d * params.G) {}
+        : Q(params.G_table(key.d)) {}
 
     const Point Q;  // Q = d*G, where G is from params, and d
                     // is the corresponding private key
 };
 
+// Batched key exchange
+//
+// Generates count key pairs for Alice and Bob and both of their shared
+// secrets. The exchanges are cut into batches of batch_size which are
+// distributed over the threads. Every batch draws its private keys at once
+// from its own xorshift64star stream, so the result depends only on seed and
+// batch_size. Within a batch, the public keys and the shared secrets are
+// computed in Jacobian coordinates and share one inversion each.
+
+template<typename DomainParams>
+struct KeyExchange {
+    using Point = typename DomainParams::E::Point;
+
+    uint64_t alice_d, bob_d;  // private keys
+    Point alice_Q, bob_Q;     // public keys
+    Point alice_S, bob_S;     // shared secret as computed by each of them
+};
+
+template<typename DomainParams>
+std::vector<KeyExchange<DomainParams>> key_exchanges(
+    const DomainParams& params, size_t count, uint64_t seed,
+    int num_threads = 1, size_t batch_size = 64)
+{
+    using E = typename DomainParams::E;
+    using J = typename E::JacobianPoint;
+    assert(num_threads > 0 && batch_size > 0);
+
+    std::vector<KeyExchange<DomainParams>> res(count);
+    const size_t batches = (count + batch_size - 1) / batch_size;
+
+    auto run_batch = [&](size_t batch) {
+        const size_t begin = batch * batch_size;
+        const size_t m = std::min(count, begin + batch_size) - begin;
+        auto* out = res.data() + begin;
+
+        xorshift64star<uint64_t> gen(stream_seed(seed, batch));
+        std::vector<uint64_t> d(2 * m);
+        for (auto& x : d) {
+            x = 1 + random_below(gen, params.n - 1);
+        }
+
+        // public keys: Alice at 2i, Bob at 2i + 1
+        std::vector<J> points(2 * m);
+        for (size_t i = 0; i < 2 * m; ++i) {
+            points[i] = params.G_table.jacobian(d[i]);
+        }
+        const auto Q = E::to_affine(points);
+
+        // shared secrets
+        for (size_t i = 0; i < m; ++i) {
+            points[2 * i] = E::wnaf_mult_jacobian(d[2 * i], Q[2 * i + 1]);
+            points[2 * i + 1] = E::wnaf_mult_jacobian(d[2 * i + 1], Q[2 * i]);
+        }
+        const auto S = E::to_affine(points);
+
+        for (size_t i = 0; i < m; ++i) {
+            out[i] = {d[2 * i], d[2 * i + 1], Q[2 * i], Q[2 * i + 1],
+                S[2 * i], S[2 * i + 1]};
+        }
+    };
+
+    std::vector<std::thread> workers;
+    const size_t num_workers = std::min<size_t>(num_threads, batches);
+    for (size_t t = 1; t < num_workers; ++t) {
+        workers.emplace_back([&, t]() {
+            for (size_t b = t; b < batches; b += num_workers) {
+                run_batch(b);
+            }
+        });
+    }
+    for (size_t b = 0; b < batches; b += num_workers) {
+        run_batch(b);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return res;
+}
+
 
 TEST_CASE("ECDH on Curve25519 over F71", "[ECDH]") {
     // I use F71 since I don't have arithmetic on large integers.
-    // TODO: Use prime 2^255 − 19
+    // For the prime 2^255 − 19, cf. x25519 in montgomery.h.
     using Curve25519 = DomainParams<71, 486662, 1>;
     using E = Curve25519::E;
 
@@ -80,21 +194,50 @@ TEST_CASE("ECDH on Curve25519 over F71", "[ECDH]") {
     REQUIRE(Pa == Pb);
 }
 
+TEST_CASE("Batched key exchange over F71", "[ECDH]") {
+    using Curve25519 = DomainParams<71, 486662, 1>;
+    using E = Curve25519::E;
+    Curve25519 params = {E::Point(7, 16), 74, 1};
+
+    const auto exchanges = key_exchanges(params, 1000, 42, 3, 64);
+    REQUIRE(exchanges.size() == 1000);
+    for (const auto& x : exchanges) {
+        REQUIRE((1 <= x.alice_d && x.alice_d < 74));
+        REQUIRE((1 <= x.bob_d && x.bob_d < 74));
+        REQUIRE(x.alice_Q == x.alice_d * params.G);
+        REQUIRE(x.bob_Q == x.bob_d * params.G);
+        REQUIRE(x.alice_S == x.alice_d * x.bob_Q);
+        REQUIRE(x.alice_S == x.bob_S);
+    }
+
+    // independent of the number of threads
+    const auto single = key_exchanges(params, 1000, 42, 1, 64);
+    for (size_t i = 0; i < exchanges.size(); ++i) {
+        REQUIRE(single[i].alice_d == exchanges[i].alice_d);
+        REQUIRE(single[i].bob_S == exchanges[i].bob_S);
+    }
+
+    REQUIRE(key_exchanges(params, 0, 42, 2).empty());
+}
+
 //
 //  Other tests
 //
 
-TEST_CASE("Value of negative int is positive", "[finite field]") {
-    using F7 = PF<7>;
-
+template<typename F7>
+void check_negative_int() {
     REQUIRE(F7(-1)() == 6);
     REQUIRE(F7(-10)() == 4);
 }
 
+TEST_CASE("Value of negative int is positive", "[finite field]") {
+    check_negative_int<PF<7>>();
+    check_negative_int<PF64<7>>();
+}
 
-TEST_CASE("Check arithmetic of F<p> elements", "[finite field]") {
-    using F7 = PF<7>;
 
+template<typename F7>
+void check_arithmetic() {
     REQUIRE(F7(0) + F7(7) == F7(0));
     REQUIRE(F7(1) + F7(7) == F7(1));
     REQUIRE(F7(1) + F7(8) == F7(2));
@@ -123,28 +266,116 @@ TEST_CASE("Check arithmetic of F<p> elements", "[finite field]") {
     REQUIRE(F7(4) / F7(3) == F7(-1));
 }
 
-TEST_CASE("Compute number of points on y^2 = x^3 + ax + b over F61 and F71",
-    "[elliptic curve]")
-{
-    using F61 = PF<61>;
+TEST_CASE("Check arithmetic of F<p> elements", "[finite field]") {
+    check_arithmetic<PF<7>>();
+    check_arithmetic<PF64<7>>();
+}
+
+// compares PF64<p> with 128-bit arithmetic for random and extreme values
+template<uint64_t p>
+void check_montgomery_field() {
+    using F = PF64<p>;
+    using u128 = unsigned __int128;
+
+    std::mt19937_64 gen(p);
+    std::vector<uint64_t> values = {0, 1, 2, p - 2, p - 1};
+    for (int i = 0; i < 50; ++i) {
+        values.push_back(gen() % p);
+    }
+
+    auto from = [](uint64_t a) {
+        // a < p might not fit into an int64_t
+        return F(static_cast<int64_t>(a >> 1)) * F(2) + F(a & 1);
+    };
+
+    for (uint64_t a : values) {
+        const F x = from(a);
+        REQUIRE(x() == a);
+        REQUIRE((-x)() == (p - a) % p);
+        if (a != 0) {
+            REQUIRE(x * x.inverse() == F(1));
+        }
+        for (uint64_t b : values) {
+            const F y = from(b);
+            REQUIRE((x + y)() == uint64_t((u128(a) + b) % p));
+            REQUIRE((x - y)() == uint64_t((u128(a) + p - b) % p));
+            REQUIRE((x * y)() == uint64_t(u128(a) * b % p));
+        }
+    }
+
+    const int64_t m = std::numeric_limits<int64_t>::min();
+    REQUIRE(F(m)() == uint64_t((p - (u128(1) << 63) % p) % p));
+    REQUIRE(F(-1)() == p - 1);
+}
+
+TEST_CASE("Arithmetic of PF64<p> for primes close to 2^64", "[finite field]") {
+    check_montgomery_field<(uint64_t(1) << 61) - 1>();
+    check_montgomery_field<(uint64_t(1) << 63) - 25>();
+    check_montgomery_field<uint64_t(-59)>();  // 2^64 - 59
+
+    // everything is constexpr
+    using F = PF64<uint64_t(-59)>;
+    static_assert(F(-1) * F(-1) == F(1), "");
+    static_assert((F(3) / F(7))() == (F(3) * F(7).inverse())(), "");
+}
+
+// table lookups against the extended Euclidean algorithm
+template<int64_t p>
+void check_log_tables(int step) {
+    using Tables = PFDivision<p, true>;
+    using Euclid = PFDivision<p, false>;
+    for (int64_t a = 0; a < p; a += step) {
+        if (a != 0) {
+            REQUIRE(Tables::inverse(a) == (Euclid::inverse(a) + p) % p);
+        }
+        for (int64_t b = 1; b < p; b += step) {
+            REQUIRE(Tables::div(a, b) == (Euclid::div(a, b) + p) % p);
+        }
+    }
+}
+
+TEST_CASE("Log tables of small prime fields", "[finite field]") {
+    static_assert(primitive_root(7) == 3, "");
+    static_assert(primitive_root(71) == 7, "");
+    static_assert(primitive_root(4093) == 2, "");
+
+    check_log_tables<7>(1);
+    check_log_tables<71>(1);
+    check_log_tables<4093>(37);
+
+    // everything is constexpr
+    using F = PF<71>;
+    static_assert(F(3) / F(7) * F(7) == F(3), "");
+    static_assert(F(0) / F(5) == F(0), "");
+    static_assert(F(-1).inverse() == F(-1), "");
+}
+
+
+template<typename F61, typename F71>
+void check_curve_size() {
     using E61 = EllipticCurve<F61, -1, 0>;
     REQUIRE(E61::size() == 72);
 
-    using F71 = PF<71>;
     using E71 = EllipticCurve<F71, -1, 0>;
     REQUIRE(E71::size() == 72);
 }
 
-TEST_CASE("Arithmetic on on y^2 = x^3 + ax + b over F7", "[elliptic curve]")
+TEST_CASE("Compute number of points on y^2 = x^3 + ax + b over F61 and F71",
+    "[elliptic curve]")
 {
-    using F = PF<7>;
+    check_curve_size<PF<61>, PF<71>>();
+    check_curve_size<PF64<61>, PF64<71>>();
+}
+
+template<typename F>
+void check_curve_arithmetic() {
     using E = EllipticCurve<F, -1, 0>;
 
-    auto O = E::Point();
-    for (int x = 0; x < F::size; ++x) {
-        for (int y = 0; y < F::size; ++y) {
+    auto O = typename E::Point();
+    for (int x = 0; x < int(F::size); ++x) {
+        for (int y = 0; y < int(F::size); ++y) {
             if (E::contains(x, y)) {
-                auto P = E::Point(x, y);
+                auto P = typename E::Point(x, y);
                 REQUIRE(P - P == O);
                 REQUIRE(P + O == P);
                 REQUIRE(P - O == P);
@@ -153,3 +384,585 @@ TEST_CASE("Arithmetic on on y^2 = x^3 + ax + b over F7", "[elliptic curve]")
         }
     }
 }
+
+TEST_CASE("Arithmetic on on y^2 = x^3 + ax + b over F7", "[elliptic curve]")
+{
+    check_curve_arithmetic<PF<7>>();
+    check_curve_arithmetic<PF64<7>>();
+}
+
+TEST_CASE("Scalar multiplication methods agree over F71", "[elliptic curve]")
+{
+    using F = PF<71>;
+    using E = EllipticCurve<F, 486662, 1>;
+
+    auto G = E::Point(7, 16);
+    auto nG = E::Point();
+    for (uint64_t n = 0; n < 200; ++n) {
+        REQUIRE(n * G == nG);
+        REQUIRE(E::double_and_add(n, G) == nG);
+        for (int w = 2; w < 7; ++w) {
+            REQUIRE(E::sliding_window_mult(n, G, w) == nG);
+            REQUIRE(E::wnaf_mult(n, G, w) == nG);
+        }
+        nG = nG + G;
+    }
+
+    // G has order 74
+    const uint64_t n = std::numeric_limits<uint64_t>::max();
+    REQUIRE(n * G == (n % 74) * G);
+}
+
+TEST_CASE("Width-w NAF of scalars", "[elliptic curve]") {
+    using E = EllipticCurve<PF<7>, -1, 0>;
+
+    REQUIRE(E::wnaf(0, 2).empty());
+    REQUIRE(E::wnaf(7, 2) == (std::vector<int>{-1, 0, 0, 1}));
+
+    std::mt19937_64 gen(42);
+    for (int w = 2; w < 8; ++w) {
+        for (int i = 0; i < 100; ++i) {
+            const uint64_t n = gen();
+            const auto digits = E::wnaf(n, w);
+
+            unsigned __int128 value = 0;
+            for (auto it = digits.rbegin(); it != digits.rend(); ++it) {
+                value = 2 * value + *it;
+                REQUIRE((*it == 0 || *it % 2 != 0));
+                REQUIRE(std::abs(*it) < (1 << (w - 1)));
+            }
+            REQUIRE(value == n);
+
+            for (size_t k = 0; k < digits.size(); ++k) {
+                for (size_t l = k + 1; l < digits.size() && l < k + w; ++l) {
+                    REQUIRE((digits[k] == 0 || digits[l] == 0));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Scalar multiplication with 64-bit scalars over F(2^255 - 19)",
+    "[elliptic curve]")
+{
+    using E = EllipticCurve<F25519, 1, 4>;
+
+    auto P = E::Point(0, 2);
+    std::mt19937_64 gen(42);
+    for (int i = 0; i < 5; ++i) {
+        const uint64_t m = gen() >> 1;
+        const uint64_t n = gen() >> 1;
+        const auto mP = E::double_and_add(m, P);
+        REQUIRE(E::sliding_window_mult(m, P) == mP);
+        REQUIRE(E::wnaf_mult(m, P) == mP);
+        REQUIRE(m * P + n * P == (m + n) * P);
+    }
+}
+
+TEST_CASE("Jacobian coordinates agree with affine coordinates",
+    "[elliptic curve]")
+{
+    using F = PF<71>;
+    using E = EllipticCurve<F, 486662, 1>;
+    using J = E::JacobianPoint;
+
+    // all multiples of G, including the identity and points of order 2
+    std::vector<E::Point> points{E::Point()};
+    auto G = E::Point(7, 16);
+    for (int i = 1; i < 74; ++i) {
+        points.push_back(points.back() + G);
+    }
+
+    for (const auto& P : points) {
+        REQUIRE(J(P).to_affine() == P);
+        REQUIRE(J(P).dbl().to_affine() == P + P);
+        for (const auto& Q : points) {
+            REQUIRE((J(P) + J(Q)).to_affine() == P + Q);
+            REQUIRE((J(P) + Q).to_affine() == P + Q);
+            REQUIRE((J(P) - Q).to_affine() == P - Q);
+        }
+    }
+
+    // different representatives of the same point
+    auto P = J(G).dbl() + G;
+    auto Q = J(G) + J(G).dbl();
+    REQUIRE(!(P.z() == Q.z()));
+    REQUIRE(P == Q);
+    REQUIRE(P.to_affine() == 3 * G);
+    REQUIRE(J() == J(E::Point()));
+}
+
+TEST_CASE("Batch inversion and batch conversion to affine coordinates",
+    "[finite field][elliptic curve]")
+{
+    using F = PF<71>;
+    std::vector<F> xs;
+    for (int i = -80; i < 80; ++i) {
+        xs.push_back(i);  // contains zeros at -71, 0 and 71
+    }
+    auto inv = xs;
+    batch_inverse(inv.begin(), inv.end());
+    for (size_t i = 0; i < xs.size(); ++i) {
+        REQUIRE(inv[i] == (xs[i] == F(0) ? F(0) : xs[i].inverse()));
+    }
+
+    std::vector<F> empty;
+    batch_inverse(empty.begin(), empty.end());
+    std::vector<F> single{F(5)};
+    batch_inverse(single.begin(), single.end());
+    REQUIRE(single[0] == F(5).inverse());
+
+    using E = EllipticCurve<F, 486662, 1>;
+    auto G = E::Point(7, 16);
+    std::vector<E::JacobianPoint> points{E::JacobianPoint()};
+    for (int i = 1; i < 74; ++i) {
+        // mix doublings and additions to get different z
+        points.push_back(i % 2 == 0
+            ? points[i / 2].dbl()
+            : points.back() + G);
+    }
+    const auto affine = E::to_affine(points);
+    REQUIRE(affine.size() == points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        REQUIRE(affine[i] == points[i].to_affine());
+        REQUIRE(affine[i] == i * G);
+    }
+}
+
+TEST_CASE("Fixed-base scalar multiplication", "[elliptic curve]") {
+    using F = PF<71>;
+    using E = EllipticCurve<F, 486662, 1>;
+
+    // order 74, so the table contains the identity
+    auto G = E::Point(7, 16);
+    E::FixedBase table(G);
+    for (uint64_t n = 0; n < 200; ++n) {
+        REQUIRE(table(n) == E::double_and_add(n, G));
+    }
+    REQUIRE(table(uint64_t(-1)) == E::double_and_add(uint64_t(-1), G));
+
+    using E25519 = EllipticCurve<F25519, 1, 4>;
+    auto P = E25519::Point(0, 2);
+    E25519::FixedBase table25519(P);
+    std::mt19937_64 gen(40);
+    for (int i = 0; i < 5; ++i) {
+        const uint64_t n = gen();
+        REQUIRE(table25519(n) == n * P);
+    }
+    // all digits 8 or 15 need carries
+    REQUIRE(table25519(0x8888888888888888) == 0x8888888888888888 * P);
+    REQUIRE(table25519(uint64_t(-1)) == uint64_t(-1) * P);
+}
+
+TEST_CASE("Multi-scalar multiplication", "[elliptic curve]") {
+    using F = PF<71>;
+    using E = EllipticCurve<F, 486662, 1>;
+
+    auto G = E::Point(7, 16);
+    std::mt19937_64 gen(41);
+    for (size_t n : {0, 1, 2, 5, 40, 100}) {
+        std::vector<uint64_t> k;
+        std::vector<E::Point> p;
+        E::Point expected;
+        for (size_t i = 0; i < n; ++i) {
+            k.push_back(i % 7 == 0 ? 0 : gen());
+            p.push_back((gen() % 74) * G);  // contains the identity
+            expected = expected + k.back() * p.back();
+        }
+        REQUIRE(E::straus(k, p) == expected);
+        REQUIRE(E::straus(k, p, 2) == expected);
+        REQUIRE(E::multi_scalar_mult(k, p) == expected);
+        for (int c : {1, 3, 8}) {
+            for (int threads : {1, 3}) {
+                REQUIRE(E::pippenger(k, p, threads, c) == expected);
+            }
+        }
+    }
+
+    using E25519 = EllipticCurve<F25519, 1, 4>;
+    auto P = E25519::Point(0, 2);
+    std::vector<uint64_t> k;
+    std::vector<E25519::Point> p;
+    E25519::Point expected;
+    for (int i = 0; i < 20; ++i) {
+        k.push_back(gen());
+        p.push_back(E25519::wnaf_mult(gen(), P));
+        expected = expected + k.back() * p.back();
+    }
+    REQUIRE(E25519::straus(k, p) == expected);
+    REQUIRE(E25519::pippenger(k, p, 2) == expected);
+}
+
+TEST_CASE("Random points over the whole field", "[elliptic curve]") {
+    // p > 2^63, so half of the field is above 2^63
+    using F = PF64<uint64_t(0) - (uint64_t(1) << 34) - 29>;
+    using E = EllipticCurve<F, 3, 5>;
+    using E25519 = EllipticCurve<F25519, 1, 4>;
+    std::mt19937_64 gen(5);
+    int high = 0;
+    int high25519 = 0;
+    for (int i = 0; i < 100; ++i) {
+        const auto P = E::random_point(gen);
+        REQUIRE(E::contains(P.x(), P.y()));
+        high += static_cast<uint64_t>(P.x()()) >> 63;
+
+        const auto Q = E25519::random_point(gen);
+        REQUIRE(E25519::contains(Q.x(), Q.y()));
+        high25519 += Q.x().to_bytes()[31] >> 6;
+    }
+    REQUIRE(high > 20);
+    REQUIRE(high25519 > 20);
+}
+
+TEST_CASE("Point compression", "[elliptic curve]") {
+    using F = PF<71>;
+    using E = EllipticCurve<F, 486662, 1>;
+
+    // 7 bits of x and two flags
+    static_assert(sizeof(E::Bytes) == 2, "");
+    static_assert(sizeof(EllipticCurve<PF64<(uint64_t(1) << 61) - 1>, 3, 5>::Bytes) == 8, "");
+    static_assert(sizeof(EllipticCurve<PF64<uint64_t(-59)>, 3, 5>::Bytes) == 9, "");
+    static_assert(sizeof(EllipticCurve<F25519, 1, 4>::Bytes) == 33, "");
+
+    // every point, then every x with both parities
+    std::vector<E::Point> points{E::Point()};
+    std::vector<E::Bytes> encoded{E::to_bytes(E::Point())};
+    std::vector<E::Bytes> invalid;
+    for (int x = 0; x < 71; ++x) {
+        for (int y = 0; y < 71; ++y) {
+            if (E::contains(x, y)) {
+                points.push_back(E::Point(x, y));
+                encoded.push_back(E::to_bytes(points.back()));
+            }
+        }
+        for (bool odd : {false, true}) {
+            E::Point p;
+            if (E::decompress({false, F(x), odd}, p)) {
+                REQUIRE(E::contains(p.x(), p.y()));
+                REQUIRE(p.x() == F(x));
+                REQUIRE(E::to_bytes(p) == E::to_bytes({false, F(x), odd}));
+            } else {
+                invalid.push_back(E::to_bytes({false, F(x), odd}));
+            }
+        }
+    }
+    // every point but the identity has one of the 2p encodings
+    REQUIRE(points.size() == E::size());
+    REQUIRE(invalid.size() == 2 * 71 - (E::size() - 1));
+
+    // x + 128 odd + 256 identity, little-endian
+    REQUIRE(E::to_bytes(E::Point()) == (E::Bytes{0, 1}));
+    REQUIRE(E::to_bytes(E::Point(7, 16)) == (E::Bytes{7, 0}));
+    REQUIRE(E::to_bytes(-E::Point(7, 16)) == (E::Bytes{135, 0}));
+
+    for (int threads : {1, 3}) {
+        std::vector<E::Point> decoded;
+        REQUIRE(E::from_bytes(encoded, decoded, threads));
+        REQUIRE(decoded == points);
+    }
+
+    // x >= p, stray bits above the flags, identity with x or sign
+    E::Point p;
+    REQUIRE(!E::from_bytes(E::Bytes{71, 0}, p));
+    REQUIRE(!E::from_bytes(E::Bytes{7, 2}, p));
+    REQUIRE(!E::from_bytes(E::Bytes{7, 1}, p));
+    REQUIRE(!E::from_bytes(E::Bytes{128, 1}, p));
+
+    encoded.push_back(invalid.front());
+    std::vector<E::Point> decoded;
+    REQUIRE(!E::from_bytes(encoded, decoded, 3));
+
+    // 61 and 255 bits
+    using E61 = EllipticCurve<PF64<(uint64_t(1) << 61) - 1>, 3, 5>;
+    using E25519 = EllipticCurve<F25519, 1, 4>;
+    std::mt19937_64 gen(47);
+    const auto P = E25519::Point(0, 2);
+    for (int i = 0; i < 20; ++i) {
+        const auto Q = gen() * P;
+        E25519::Point R;
+        REQUIRE(E25519::from_bytes(E25519::to_bytes(Q), R));
+        REQUIRE(R == Q);
+
+        const auto S = E61::random_point(gen);
+        E61::Point T;
+        REQUIRE(E61::from_bytes(E61::to_bytes(S), T));
+        REQUIRE(T == S);
+    }
+
+    // x = p = 2^255 - 19 is not canonical
+    E25519::Bytes s{};
+    s.fill(0xFF);
+    s[0] = 0xED;
+    s[31] = 0x7F;
+    s[32] = 0;
+    E25519::Point R;
+    REQUIRE(!E25519::from_bytes(s, R));
+}
+
+template<typename F, int64_t a, int64_t b>
+void check_bsgs_size() {
+    using E = EllipticCurve<F, a, b>;
+    const uint64_t size = E::size();
+    for (uint64_t seed = 1; seed <= 3; ++seed) {
+        REQUIRE(E::bsgs_size(seed) == size);
+    }
+
+    std::mt19937_64 gen(7);
+    for (int i = 0; i < 10; ++i) {
+        const auto P = E::random_point(gen);
+        const uint64_t n = E::order(P, size);
+        REQUIRE(size % n == 0);
+        REQUIRE((n * P).identity());
+        for (uint64_t q : factor(n)) {
+            REQUIRE(!((n / q) * P).identity());
+        }
+    }
+}
+
+// #E in the Hasse interval and #E P = O
+template<typename F, int64_t a, int64_t b>
+void check_bsgs_hasse() {
+    using E = EllipticCurve<F, a, b>;
+    const uint64_t size = E::bsgs_size();
+    const uint64_t p = F::characteristic;
+    const __int128 t = __int128(size) - p - 1;
+    REQUIRE(t * t <= 4 * __int128(p));
+    std::mt19937_64 gen(11);
+    for (int i = 0; i < 10; ++i) {
+        REQUIRE((size * E::random_point(gen)).identity());
+    }
+}
+
+TEST_CASE("Group order by baby-step giant-step", "[elliptic curve]") {
+    check_bsgs_size<PF<71>, 486662, 1>();
+    check_bsgs_size<PF<1009>, 2, 3>();
+    check_bsgs_size<PF<10007>, -3, 7>();
+    check_bsgs_size<PF<1000003>, 0, 5>();  // j = 0, p = 1 mod 3
+    check_bsgs_size<PF<1000003>, 1, 0>();  // j = 1728
+    check_bsgs_size<PF64<1000000007>, 3, 5>();
+    check_bsgs_size<PF64<(uint64_t(1) << 40) - 87>, 3, 5>();
+
+    // too large for the Legendre sum, Schoof takes seconds; near 2^63 the
+    // multiples of the orders exceed 2^64, near 2^64 the Hasse bound does
+    check_bsgs_hasse<PF64<(uint64_t(1) << 61) - 1>, 3, 5>();
+    check_bsgs_hasse<PF64<(uint64_t(1) << 63) - 25>, 3, 5>();
+    check_bsgs_hasse<PF64<uint64_t(0) - (uint64_t(1) << 34) - 29>, 3, 5>();
+}
+
+TEST_CASE("Domain parameters from the group order", "[ECDH]") {
+    // E(F71) has 74 = 2 * 37 points, so it is cyclic
+    const auto params = make_domain_params<PF<71>, 486662, 1>();
+    REQUIRE(params.n == 74);
+    REQUIRE(params.h == 1);
+    REQUIRE((params.n * params.G).identity());
+    REQUIRE(!((params.n / 2) * params.G).identity());
+    REQUIRE(!((params.n / 37) * params.G).identity());
+
+    const auto exchanges = key_exchanges(params, 100, 42);
+    for (const auto& x : exchanges) {
+        REQUIRE(x.alice_S == x.bob_S);
+    }
+
+    // y^2 = x^3 - x has the 4 points of order 2 and is never cyclic
+    const auto split = make_domain_params<PF<1009>, -1, 0>();
+    REQUIRE(split.n * split.h == EllipticCurve<PF<1009>, -1, 0>::size());
+    REQUIRE(split.h % 2 == 0);
+
+    // 61 bits
+    using F = PF64<(uint64_t(1) << 61) - 1>;
+    const auto large = make_domain_params<F, 3, 5>();
+    REQUIRE((large.n * large.G).identity());
+    REQUIRE(large.h < 1000);
+}
+
+// ./ecdh [benchmark]
+TEST_CASE("Affine point addition with and without log tables", "[.][benchmark]") {
+    auto measure = [](const char* name, auto curve, int p) {
+        using E = decltype(curve);
+        // a point of the curve y^2 = x^3 + 2x + 3
+        typename E::Point P;
+        for (int x = 0; P.identity(); ++x) {
+            for (int y = 0; y < p; ++y) {
+                if (E::contains(x, y)) {
+                    P = typename E::Point(x, y);
+                    break;
+                }
+            }
+        }
+
+        // walk through the multiples of P, one division per addition
+        const int n = 10000000;
+        typename E::Point res;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; ++i) {
+            res = res + P;
+        }
+        auto end = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed = end - start;
+        std::cout << name << ": " << n / elapsed.count() << " ops/s" << std::endl;
+        return res.identity();
+    };
+
+    // the largest prime below LOG_TABLE_THRESHOLD and the smallest above
+    measure("F4093, log tables", EllipticCurve<PF<4093>, 2, 3>(), 4093);
+    measure("F4099, Euclid", EllipticCurve<PF<4099>, 2, 3>(), 4099);
+}
+
+TEST_CASE("Group order by baby-step giant-step and by Schoof", "[.][benchmark]") {
+    auto measure = [](const char* name, auto count) {
+        auto start = std::chrono::steady_clock::now();
+        const uint64_t size = count();
+        auto end = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed = end - start;
+        std::cout << name << ": #E = " << size << " in " << elapsed.count()
+            << " s" << std::endl;
+        return size;
+    };
+
+    using E40 = EllipticCurve<PF64<(uint64_t(1) << 40) - 87>, 3, 5>;
+    using E61 = EllipticCurve<PF64<(uint64_t(1) << 61) - 1>, 3, 5>;
+    measure("2^40 - 87, BSGS", [] { return E40::bsgs_size(); });
+    measure("2^40 - 87, Schoof", [] { return E40::size(); });
+    measure("2^61 - 1, BSGS", [] { return E61::bsgs_size(); });
+    measure("2^61 - 1, Schoof", [] { return E61::size(); });
+}
+
+// ./ecdh [benchmark]
+TEST_CASE("Scalar multiplication throughput", "[.][benchmark]") {
+    using E = EllipticCurve<F25519, 1, 4>;
+    auto P = E::Point(0, 2);
+
+    auto measure = [&P](const char* name, E::Point (*mult)(uint64_t, const E::Point&)) {
+        std::mt19937_64 gen(42);
+        const int n = 200;
+        E::Point res;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; ++i) {
+            res = res + mult(gen(), P);
+        }
+        auto end = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed = end - start;
+        std::cout << name << ": " << n / elapsed.count() << " ops/s" << std::endl;
+        return res;
+    };
+
+    auto a = measure("double-and-add", [](uint64_t n, const E::Point& p) {
+        return E::double_and_add(n, p);
+    });
+    auto b = measure("sliding window (w = 4)", [](uint64_t n, const E::Point& p) {
+        return E::sliding_window_mult(n, p, 4);
+    });
+    auto c = measure("w-NAF (w = 5)", [](uint64_t n, const E::Point& p) {
+        return E::wnaf_mult(n, p, 5);
+    });
+    static const E::FixedBase table(P);
+    auto d = measure("fixed base", [](uint64_t n, const E::Point&) {
+        return table(n);
+    });
+    REQUIRE(a == b);
+    REQUIRE(b == c);
+    REQUIRE(c == d);
+}
+
+// ./ecdh [benchmark]
+TEST_CASE("Batch conversion to affine coordinates throughput", "[.][benchmark]") {
+    using E = EllipticCurve<F25519, 1, 4>;
+    auto P = E::Point(0, 2);
+
+    std::vector<E::JacobianPoint> points{E::JacobianPoint(P)};
+    for (int i = 1; i < 1000; ++i) {
+        points.push_back(points.back().dbl());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<E::Point> single;
+    for (const auto& p : points) {
+        single.push_back(p.to_affine());
+    }
+    auto mid = std::chrono::steady_clock::now();
+    const auto batch = E::to_affine(points);
+    auto end = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double> t_single = mid - start;
+    std::chrono::duration<double> t_batch = end - mid;
+    std::cout << "to_affine, one by one: "
+        << points.size() / t_single.count() << " points/s" << std::endl;
+    std::cout << "to_affine, batch: "
+        << points.size() / t_batch.count() << " points/s" << std::endl;
+    REQUIRE(single == batch);
+}
+
+// ./ecdh [benchmark]
+TEST_CASE("Multi-scalar multiplication throughput", "[.][benchmark]") {
+    using E = EllipticCurve<F25519, 1, 4>;
+    auto P = E::Point(0, 2);
+    const int threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::mt19937_64 gen(42);
+    std::vector<uint64_t> k;
+    std::vector<E::Point> p;
+    for (size_t n : {4, 8, 12, 16, 64, 256, 1024, 4096}) {
+        while (k.size() < n) {
+            k.push_back(gen());
+            p.push_back(E::wnaf_mult(gen(), P));
+        }
+
+        auto measure = [&](const char* name, auto mult) {
+            auto start = std::chrono::steady_clock::now();
+            const auto res = mult();
+            auto end = std::chrono::steady_clock::now();
+            std::chrono::duration<double> elapsed = end - start;
+            std::cout << "n = " << n << ", " << name << ": "
+                << n / elapsed.count() << " points/s" << std::endl;
+            return res;
+        };
+
+        auto a = measure("separately", [&]() {
+            E::Point res;
+            for (size_t i = 0; i < n; ++i) {
+                res = res + E::wnaf_mult(k[i], p[i]);
+            }
+            return res;
+        });
+        auto b = measure("Straus", [&]() { return E::straus(k, p); });
+        auto c = measure("Pippenger", [&]() { return E::pippenger(k, p); });
+        auto d = measure("Pippenger, all threads", [&]() {
+            return E::pippenger(k, p, threads);
+        });
+        REQUIRE(a == b);
+        REQUIRE(b == c);
+        REQUIRE(c == d);
+    }
+}
+
+// ./ecdh [benchmark]
+TEST_CASE("Key exchange throughput", "[.][benchmark]") {
+    // The order of (0, 2) on y^2 = x^3 + x + 4 over F(2^255 - 19) is not
+    // known, but all we need is a bound for the 64-bit private keys.
+    using Domain = CurveDomainParams<F25519, 1, 4>;
+    Domain params = {Domain::Point(0, 2), uint64_t(1) << 63, 1};
+    const int threads = std::max(1u, std::thread::hardware_concurrency());
+    const size_t count = 2000;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        PrivateKey<Domain> alice_priv(params);
+        PublicKey<Domain> alice_pub(params, alice_priv);
+        PrivateKey<Domain> bob_priv(params);
+        PublicKey<Domain> bob_pub(params, bob_priv);
+        REQUIRE(alice_priv.d * bob_pub.Q == bob_priv.d * alice_pub.Q);
+    }
+    auto mid = std::chrono::steady_clock::now();
+    const auto exchanges = key_exchanges(params, count, 42, threads);
+    auto end = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double> t_single = mid - start;
+    std::chrono::duration<double> t_batch = end - mid;
+    std::cout << "one by one: " << count / t_single.count()
+        << " exchanges/s" << std::endl;
+    std::cout << "batched, " << threads << " threads: "
+        << count / t_batch.count() << " exchanges/s, "
+        << count / t_batch.count() / threads << " exchanges/s/core"
+        << std::endl;
+    REQUIRE(exchanges.back().alice_S == exchanges.back().bob_S);
+}
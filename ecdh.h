@@ -1,4 +1,17 @@
+#pragma once
+
+#include "point_counting.h"
+#include "sqrt.h"
+#include "factor.h"
+
+#include <array>
 #include <ostream>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <thread>
+#include <random>
+#include <unordered_map>
 #include <assert.h>
 
 //
@@ -35,6 +48,106 @@ constexpr int64_t mod_inverse(int64_t a, int64_t n) {
     return x1;
 }
 
+// base^e mod n
+constexpr int64_t pow_mod(int64_t base, int64_t e, int64_t n) {
+    int64_t result = 1 % n;
+    for (base %= n; e > 0; e >>= 1, base = base * base % n) {
+        if (e & 1) {
+            result = result * base % n;
+        }
+    }
+    return result;
+}
+
+// smallest generator of the multiplicative group of F_p: g is one iff
+// g^((p - 1)/q) != 1 for every prime divisor q of p - 1
+constexpr int64_t primitive_root(int64_t p) {
+    for (int64_t g = 1; g < p; ++g) {
+        bool generates = true;
+        int64_t m = p - 1;
+        for (int64_t q = 2; m > 1 && generates; ++q) {
+            if (m % q != 0) {
+                continue;
+            }
+            generates = pow_mod(g, (p - 1) / q, p) != 1;
+            while (m % q == 0) {
+                m /= q;
+            }
+        }
+        if (generates) {
+            return g;
+        }
+    }
+    return 0;
+}
+
+
+//
+// Discrete logarithm tables of small prime fields
+//
+// With a primitive root g, every x != 0 is g^log(x), so x / y = g^(log x -
+// log y) and 1/x = g^(p - 1 - log x). Both tables are built at compile time;
+// exp has 2(p - 1) entries, so that the sum of two logarithms needs no
+// reduction.
+//
+// Only division and inverse use them: an inverse is two lookups instead of
+// the extended Euclidean algorithm (8 ns vs 55 ns for p = 4093 with -O2, and
+// affine point additions get 3 times faster, cf. the benchmark in ecdh.cpp),
+// but a product modulo a constant p is a multiplication and a shift, which
+// is as fast as three dependent lookups and vectorizes, unlike the lookups.
+//
+
+// fields with fewer elements divide and invert by table lookup (the tables
+// take 6p bytes)
+constexpr int64_t LOG_TABLE_THRESHOLD = 1 << 12;
+
+template<int64_t p>
+struct LogTables {
+    static_assert(p < LOG_TABLE_THRESHOLD, "tables only for small fields");
+
+    constexpr LogTables() : exp{}, log{} {
+        const int64_t g = primitive_root(p);
+        int64_t x = 1;
+        for (int64_t i = 0; i < 2 * (p - 1); ++i) {
+            exp[i] = static_cast<uint16_t>(x);
+            if (i < p - 1) {
+                log[x] = static_cast<uint16_t>(i);
+            }
+            x = x * g % p;
+        }
+    }
+
+    // C arrays, since std::array::operator[] is not constexpr in C++14
+    uint16_t exp[2 * (p - 1)];
+    uint16_t log[p];  // log[0] is unused
+};
+
+// division and inverse of reduced representatives, the results may be
+// negative
+template<int64_t p, bool = (p < LOG_TABLE_THRESHOLD)>
+struct PFDivision {
+    static constexpr int64_t div(int64_t a, int64_t b) {
+        return a * mod_inverse(b, p) % p;
+    }
+    static constexpr int64_t inverse(int64_t a) { return mod_inverse(a, p); }
+};
+
+template<int64_t p>
+struct PFDivision<p, true> {
+    static constexpr LogTables<p> tables{};
+
+    static constexpr int64_t div(int64_t a, int64_t b) {
+        return a == 0 ? 0 : tables.exp[tables.log[a] + (p - 1) - tables.log[b]];
+    }
+    static constexpr int64_t inverse(int64_t a) {
+        return tables.exp[(p - 1) - tables.log[a]];
+    }
+};
+
+template<int64_t p>
+constexpr LogTables<p> PFDivision<p, true>::tables;
+
+
 //
 // Finite prime field (of characteristic p)
 //
@@ -50,13 +163,13 @@ public:
 
     constexpr PF<p> inverse() const {
         assert(a_ != 0);
-        return mod_inverse(a_, p);
+        return PFDivision<p>::inverse(a_);
     }
 
     constexpr PF<p> operator-() const { return -a_; }
 
 private:
-    const int64_t a_;
+    int64_t a_;
 };
 
 
@@ -83,7 +196,8 @@ constexpr PF<p> operator*(const PF<p> x, const PF<p> y) {
 
 template<int64_t p>
 constexpr PF<p> operator/(const PF<p> x, const PF<p> y) {
-    return PF<p>(x * y.inverse());
+    assert(y() != 0);
+    return PFDivision<p>::div(x(), y());
 }
 
 template<int64_t p>
@@ -96,12 +210,276 @@ std::ostream& operator<<(std::ostream& os, const PF<p> x) {
     return os << x();
 }
 
+//
+// Finite prime field for odd primes p < 2^64 in Montgomery form
+//
+// PF<p> multiplies two int64_t residues and reduces with %, which overflows
+// for p > 2^31.5 and needs a hardware division. PF64<p> stores a as
+// aR mod p with R = 2^64 and multiplies via a 128-bit product followed by
+// Montgomery reduction (REDC), which needs only multiplications and shifts.
+// Conversion from and to the usual representation happens only in the
+// constructor and in operator().
+//
+// Cf. P. L. Montgomery, "Modular multiplication without trial division",
+// 1985.
+//
+template<uint64_t p /* odd prime */>
+class PF64 {
+public:
+    static constexpr uint64_t characteristic = p;
+    static constexpr uint64_t size = p;
+
+    constexpr PF64(int64_t a) : a_(to_montgomery(reduce(a))) {}
+
+    // canonical representative in [0, p)
+    constexpr uint64_t operator()() const { return redc(a_); }
+
+    constexpr PF64<p> inverse() const {
+        assert(a_ != 0);
+        // Fermat: a^(p - 2)
+        PF64<p> res = 1;
+        PF64<p> base = *this;
+        for (uint64_t e = p - 2; e > 0; e >>= 1) {
+            if (e & 1) {
+                res = res * base;
+            }
+            base = base * base;
+        }
+        return res;
+    }
+
+    constexpr PF64<p> operator-() const { return from_montgomery(a_ == 0 ? 0 : p - a_); }
+
+    // raw access to the Montgomery representation aR mod p
+    constexpr uint64_t montgomery() const { return a_; }
+    static constexpr PF64<p> from_montgomery(uint64_t a) {
+        PF64<p> x = 0;
+        x.a_ = a;
+        return x;
+    }
+
+    // T R^(-1) mod p for T < pR
+    static constexpr uint64_t redc(unsigned __int128 t) {
+        const uint64_t lo = static_cast<uint64_t>(t);
+        const uint64_t hi = static_cast<uint64_t>(t >> 64);
+        const uint64_t m = lo * P_INV;
+        const unsigned __int128 mp = static_cast<unsigned __int128>(m) * p;
+        // lo + (mp mod R) is either 0 or R
+        const unsigned __int128 r =
+            static_cast<unsigned __int128>(hi) + (mp >> 64) + (lo != 0);
+        return static_cast<uint64_t>(r >= p ? r - p : r);
+    }
+
+private:
+    // -p^(-1) mod 2^64 by Newton iteration, every step doubles the number of
+    // correct bits
+    static constexpr uint64_t neg_inverse() {
+        uint64_t inv = p;  // correct to 3 bits, since p is odd
+        for (int i = 0; i < 5; ++i) {
+            inv *= 2 - p * inv;
+        }
+        return ~inv + 1;
+    }
+
+    static constexpr uint64_t reduce(int64_t a) {
+        const uint64_t abs = a < 0 ? ~uint64_t(a) + 1 : uint64_t(a);
+        const uint64_t r = abs % p;
+        return a < 0 && r != 0 ? p - r : r;
+    }
+
+    // R^2 mod p
+    static constexpr uint64_t r2() {
+        const unsigned __int128 r = (static_cast<unsigned __int128>(1) << 64) % p;
+        return static_cast<uint64_t>(r * r % p);
+    }
+
+    static constexpr uint64_t to_montgomery(uint64_t a) {
+        return redc(static_cast<unsigned __int128>(a) * R2);
+    }
+
+    static constexpr uint64_t P_INV = neg_inverse();
+    static constexpr uint64_t R2 = r2();
+
+    static_assert(p % 2 == 1, "p has to be odd");
+
+    uint64_t a_;
+};
+
+
+template<uint64_t p>
+constexpr PF64<p> operator+(const PF64<p> x, const PF64<p> y) {
+    const uint64_t a = x.montgomery();
+    const uint64_t s = a + y.montgomery();
+    // s - p is correct modulo 2^64 also if a + b overflowed
+    return PF64<p>::from_montgomery(s < a || s >= p ? s - p : s);
+}
+
+template<uint64_t p>
+constexpr PF64<p> operator-(const PF64<p> x, const PF64<p> y) {
+    const uint64_t a = x.montgomery();
+    const uint64_t b = y.montgomery();
+    return PF64<p>::from_montgomery(a < b ? a - b + p : a - b);
+}
+
+template<uint64_t p>
+constexpr PF64<p> operator*(const PF64<p> x, const PF64<p> y) {
+    return PF64<p>::from_montgomery(PF64<p>::redc(
+        static_cast<unsigned __int128>(x.montgomery()) * y.montgomery()));
+}
+
+// Z-module structure
+template<uint64_t p>
+constexpr PF64<p> operator*(int64_t a, const PF64<p> y) {
+    return PF64<p>(a) * y;
+}
+
+template<uint64_t p>
+constexpr PF64<p> operator/(const PF64<p> x, const PF64<p> y) {
+    return x * y.inverse();
+}
+
+template<uint64_t p>
+constexpr bool operator==(const PF64<p> x, const PF64<p> y) {
+    return x.montgomery() == y.montgomery();
+}
+
+template<uint64_t p>
+std::ostream& operator<<(std::ostream& os, const PF64<p> x) {
+    return os << x();
+}
+
 // generic neq
 template<typename T>
 constexpr bool operator!=(const T& a, const T& b) {
     return !(a == b);
 }
 
+// Montgomery's simultaneous inversion
+//
+// Replaces every element of [begin, end) by its inverse using a single
+// inversion and 3(n - 1) multiplications: with prefix products
+// c_i = x_0 ... x_i, the inverse of c_(n-1) yields x_i^(-1) = c_(i-1) c_i^(-1)
+// and c_(i-1)^(-1) = x_i c_i^(-1) from the back. Zeros are not invertible
+// and are left as they are.
+template<typename Iter>
+void batch_inverse(Iter begin, Iter end) {
+    using F = typename std::iterator_traits<Iter>::value_type;
+
+    std::vector<F> prefix;
+    prefix.reserve(std::distance(begin, end));
+    F acc = 1;
+    for (Iter it = begin; it != end; ++it) {
+        if (!(*it == F(0))) {
+            acc = acc * *it;
+        }
+        prefix.push_back(acc);
+    }
+    if (prefix.empty()) {
+        return;
+    }
+
+    F inv = acc.inverse();
+    size_t i = prefix.size();
+    for (Iter it = end; it != begin; ) {
+        --it, --i;
+        if (*it == F(0)) {
+            continue;
+        }
+        const F x = *it;
+        *it = i > 0 ? inv * prefix[i - 1] : inv;
+        inv = inv * x;
+    }
+}
+
+//
+// Field elements in the bytes of encoded points: x little-endian in the
+// lowest bits() bits of size bytes, which leave at least two spare bits for
+// flags. Generic for fields of characteristic < 2^64, F25519 below.
+//
+
+template<typename F>
+struct PointEncoding {
+    static constexpr int bits() {
+        int n = 0;
+        for (uint64_t p = static_cast<uint64_t>(F::characteristic); p > 0; p >>= 1) {
+            n += 1;
+        }
+        return n;
+    }
+    static constexpr size_t size = (bits() + 2 + 7) / 8;
+    using Bytes = std::array<uint8_t, size>;
+
+    static void store(const F& x, Bytes& s) {
+        const uint64_t v = static_cast<uint64_t>(x());
+        for (size_t i = 0; i < size && i < 8; ++i) {
+            s[i] = static_cast<uint8_t>(v >> (8 * i));
+        }
+    }
+
+    // false if the value is not canonical, i.e. >= p
+    static bool load(const Bytes& s, F& x) {
+        uint64_t v = 0;
+        for (size_t i = std::min<size_t>(size, 8); i-- > 0; ) {
+            v = (v << 8) | s[i];
+        }
+        if (bits() < 64) {
+            v &= (uint64_t(1) << bits()) - 1;
+        }
+        if (v >= static_cast<uint64_t>(F::characteristic)) {
+            return false;
+        }
+        // F has only a constructor from int64_t
+        x = F(static_cast<int64_t>(v >> 1)) * F(2) + F(static_cast<int64_t>(v & 1));
+        return true;
+    }
+
+    // 64 random bits mod p, i.e. (almost) uniform over the whole field
+    template<typename Gen>
+    static F random(Gen& gen) {
+        const uint64_t v = std::uniform_int_distribution<uint64_t>()(gen);
+        return F(static_cast<int64_t>(v >> 1)) * F(2) + F(static_cast<int64_t>(v & 1));
+    }
+};
+
+template<typename F>
+constexpr size_t PointEncoding<F>::size;
+
+// 255 bits, 33 bytes
+template<>
+struct PointEncoding<F25519> {
+    static constexpr int bits() { return 255; }
+    static constexpr size_t size = 33;
+    using Bytes = std::array<uint8_t, size>;
+
+    static void store(const F25519& x, Bytes& s) {
+        const auto t = x.to_bytes();
+        std::copy(t.begin(), t.end(), s.begin());
+    }
+
+    static bool load(const Bytes& s, F25519& x) {
+        std::array<uint8_t, 32> t;
+        std::copy(s.begin(), s.begin() + 32, t.begin());
+        t[31] &= 0x7F;
+        x = F25519::from_bytes(t);
+        return x.to_bytes() == t;
+    }
+
+    // 255 random bits mod p
+    template<typename Gen>
+    static F25519 random(Gen& gen) {
+        std::uniform_int_distribution<uint64_t> dis;
+        std::array<uint8_t, 32> t;
+        for (size_t i = 0; i < t.size(); i += 8) {
+            const uint64_t v = dis(gen);
+            for (size_t k = 0; k < 8; ++k) {
+                t[i + k] = static_cast<uint8_t>(v >> (8 * k));
+            }
+        }
+        return F25519::from_bytes(t);
+    }
+};
+
+
 //
 // Elliptic curve
 //
@@ -165,9 +543,8 @@ public:
         }
 
         // Z-module structure
-        // TODO: This can be done better.
         friend const Point operator*(uint64_t n, const Point& p) {
-            return mult(n, p, p);
+            return wnaf_mult(n, p);
         }
 
         // output
@@ -179,17 +556,440 @@ public:
         }
 
     private:
-        friend const Point mult(uint64_t n, const Point& p, const Point& res) {
-            if (n == 0) {
+        bool identity_;
+        F x_, y_;
+    };
+
+    // Jacobian coordinates
+    //
+    // (X : Y : Z) represents the affine point (X/Z^2, Y/Z^3), Z = 0 is the
+    // identity. Addition and doubling need no inversion, so only the final
+    // conversion to affine coordinates pays for one.
+    class JacobianPoint {
+    public:
+        // identity point (at infinity)
+        JacobianPoint() : x_(1), y_(1), z_(0) {}
+        // affine point
+        explicit JacobianPoint(const Point& p)
+            : x_(p.identity() ? F(1) : p.x())
+            , y_(p.identity() ? F(1) : p.y())
+            , z_(p.identity() ? F(0) : F(1))
+        {}
+        JacobianPoint(const F& x, const F& y, const F& z)
+            : x_(x), y_(y), z_(z) {}
+
+        bool identity() const { return z_ == F(0); }
+        const F x() const { return x_; }
+        const F y() const { return y_; }
+        const F z() const { return z_; }
+
+        const Point to_affine() const {
+            if (identity()) {
                 return Point();
-            } else if (n == 1) {
-                return res;
             }
-            return mult(n - 1, p, res + p);
+            const F zinv = z_.inverse();
+            const F zinv2 = zinv * zinv;
+            return Point(x_ * zinv2, y_ * zinv2 * zinv);
+        }
+
+        bool operator==(const JacobianPoint& p) const {
+            if (identity() || p.identity()) {
+                return identity() && p.identity();
+            }
+            const F zz1 = z_ * z_;
+            const F zz2 = p.z_ * p.z_;
+            return x_ * zz2 == p.x_ * zz1
+                && y_ * zz2 * p.z_ == p.y_ * zz1 * z_;
+        }
+
+        // 2P, 4M + 6S
+        const JacobianPoint dbl() const {
+            if (identity() || y_ == F(0)) {
+                return JacobianPoint();
+            }
+            const F xx = x_ * x_;
+            const F yy = y_ * y_;
+            const F zz = z_ * z_;
+            const F s = 4 * x_ * yy;
+            const F m = 3 * xx + a * zz * zz;
+            const F x3 = m * m - 2 * s;
+            const F y3 = m * (s - x3) - 8 * yy * yy;
+            const F z3 = 2 * y_ * z_;
+            return JacobianPoint(x3, y3, z3);
         }
 
-        const bool identity_;
-        const F x_, y_;
+        // P + Q, 12M + 4S
+        const JacobianPoint operator+(const JacobianPoint& p) const {
+            if (identity()) {
+                return p;
+            } else if (p.identity()) {
+                return *this;
+            }
+
+            const F zz1 = z_ * z_;
+            const F zz2 = p.z_ * p.z_;
+            const F u1 = x_ * zz2;
+            const F u2 = p.x_ * zz1;
+            const F s1 = y_ * zz2 * p.z_;
+            const F s2 = p.y_ * zz1 * z_;
+            return add(u1, u2, s1, s2, z_ * p.z_);
+        }
+
+        // mixed addition P + Q with affine Q, 8M + 3S
+        const JacobianPoint operator+(const Point& p) const {
+            if (p.identity()) {
+                return *this;
+            } else if (identity()) {
+                return JacobianPoint(p);
+            }
+
+            const F zz1 = z_ * z_;
+            const F u2 = p.x() * zz1;
+            const F s2 = p.y() * zz1 * z_;
+            return add(x_, u2, y_, s2, z_);
+        }
+
+        const JacobianPoint operator-() const {
+            return JacobianPoint(x_, -y_, z_);
+        }
+
+        const JacobianPoint operator-(const JacobianPoint& p) const {
+            return (*this) + (-p);
+        }
+
+        const JacobianPoint operator-(const Point& p) const {
+            return (*this) + (-p);
+        }
+
+    private:
+        // (u1 : s1) + (u2 : s2) with both scaled to the same z
+        const JacobianPoint add(const F& u1, const F& u2,
+            const F& s1, const F& s2, const F& z) const
+        {
+            if (u1 == u2) {
+                return s1 == s2 ? dbl() : JacobianPoint();
+            }
+            const F h = u2 - u1;
+            const F r = s2 - s1;
+            const F hh = h * h;
+            const F hhh = hh * h;
+            const F v = u1 * hh;
+            const F x3 = r * r - hhh - 2 * v;
+            const F y3 = r * (v - x3) - s1 * hhh;
+            return JacobianPoint(x3, y3, z * h);
+        }
+
+        F x_, y_, z_;
+    };
+
+    // Batch conversion to affine coordinates with one inversion for all
+    // points, cf. batch_inverse. The identity stays the identity.
+    static std::vector<Point> to_affine(const std::vector<JacobianPoint>& points) {
+        std::vector<F> zinv;
+        zinv.reserve(points.size());
+        for (const auto& p : points) {
+            zinv.push_back(p.z());
+        }
+        batch_inverse(zinv.begin(), zinv.end());
+
+        std::vector<Point> res;
+        res.reserve(points.size());
+        for (size_t i = 0; i < points.size(); ++i) {
+            if (points[i].identity()) {
+                res.push_back(Point());
+                continue;
+            }
+            const F zinv2 = zinv[i] * zinv[i];
+            res.push_back(Point(points[i].x() * zinv2, points[i].y() * zinv2 * zinv[i]));
+        }
+        return res;
+    }
+
+    // Scalar multiplication
+    //
+    // All methods accumulate in Jacobian coordinates and convert to affine
+    // coordinates only once at the end.
+
+    // binary method, left to right
+    static Point double_and_add(uint64_t n, const Point& p) {
+        JacobianPoint res;
+        for (int i = 63; i >= 0; --i) {
+            res = res.dbl();
+            if ((n >> i) & 1) {
+                res = res + p;
+            }
+        }
+        return res.to_affine();
+    }
+
+    // p, 3p, 5p, ..., (2^(w - 1) - 1)p
+    static std::vector<JacobianPoint> odd_multiples(const Point& p, int w) {
+        std::vector<JacobianPoint> table{JacobianPoint(p)};
+        const JacobianPoint p2 = table.back().dbl();
+        for (int i = 1; i < (1 << (w - 2)); ++i) {
+            table.push_back(table.back() + p2);
+        }
+        return table;
+    }
+
+    // Sliding window of width w: every window is an odd multiple of p read
+    // from a table, so there is one addition per window instead of one per
+    // non-zero bit.
+    static Point sliding_window_mult(uint64_t n, const Point& p, int w = 4) {
+        assert(2 <= w && w <= 8);
+        const auto table = odd_multiples(p, w + 1);
+
+        JacobianPoint res;
+        int i = 63;
+        while (i >= 0) {
+            if (((n >> i) & 1) == 0) {
+                res = res.dbl();
+                i -= 1;
+                continue;
+            }
+
+            // longest window n[i..j] of at most w bits ending with a one
+            int j = std::max(i - w + 1, 0);
+            while (((n >> j) & 1) == 0) {
+                j += 1;
+            }
+            const uint64_t window = (n >> j) & ((uint64_t(1) << (i - j + 1)) - 1);
+            for (int k = j; k <= i; ++k) {
+                res = res.dbl();
+            }
+            res = res + table[window / 2];
+            i = j - 1;
+        }
+        return res.to_affine();
+    }
+
+    // width-w non-adjacent form: digits are zero or odd with absolute value
+    // below 2^(w - 1), and of any w consecutive digits at most one is
+    // non-zero, least significant first
+    static std::vector<int> wnaf(uint64_t n, int w) {
+        std::vector<int> digits;
+        unsigned __int128 k = n;
+        while (k > 0) {
+            int d = 0;
+            if (k & 1) {
+                d = static_cast<int>(k & ((1 << w) - 1));
+                if (d >= (1 << (w - 1))) {
+                    d -= 1 << w;
+                }
+                k = d > 0 ? k - d : k + (-d);
+            }
+            digits.push_back(d);
+            k >>= 1;
+        }
+        return digits;
+    }
+
+    // w-NAF: like the sliding window, but negation of points is free, so
+    // the table needs only half the odd multiples for the same density of
+    // additions (1/(w + 1) of the bits).
+    static Point wnaf_mult(uint64_t n, const Point& p, int w = 5) {
+        return wnaf_mult_jacobian(n, p, w).to_affine();
+    }
+
+    // without the final inversion, e.g. to share it by to_affine of many
+    // points
+    static JacobianPoint wnaf_mult_jacobian(uint64_t n, const Point& p,
+        int w = 5)
+    {
+        assert(2 <= w && w <= 8);
+        const auto digits = wnaf(n, w);
+        const auto table = odd_multiples(p, w);
+
+        JacobianPoint res;
+        for (auto it = digits.rbegin(); it != digits.rend(); ++it) {
+            res = res.dbl();
+            if (*it > 0) {
+                res = res + table[*it / 2];
+            } else if (*it < 0) {
+                res = res - table[-*it / 2];
+            }
+        }
+        return res;
+    }
+
+    // Multi-scalar multiplication k_0 p_0 + ... + k_(n-1) p_(n-1)
+
+    // Straus: the w-NAF of all scalars are processed together, so the
+    // doublings are shared by all points. The tables of odd multiples are
+    // converted to affine coordinates with one batch inversion.
+    static Point straus(const std::vector<uint64_t>& k,
+        const std::vector<Point>& p, int w = 5)
+    {
+        assert(k.size() == p.size());
+        assert(2 <= w && w <= 8);
+        const size_t n = k.size();
+        const size_t half = size_t(1) << (w - 2);
+
+        std::vector<std::vector<int>> digits(n);
+        std::vector<JacobianPoint> tables;
+        tables.reserve(n * half);
+        size_t length = 0;
+        for (size_t i = 0; i < n; ++i) {
+            digits[i] = wnaf(k[i], w);
+            length = std::max(length, digits[i].size());
+            const auto table = odd_multiples(p[i], w);
+            tables.insert(tables.end(), table.begin(), table.end());
+        }
+        const auto affine = to_affine(tables);
+
+        JacobianPoint res;
+        for (size_t j = length; j-- > 0; ) {
+            res = res.dbl();
+            for (size_t i = 0; i < n; ++i) {
+                const int d = j < digits[i].size() ? digits[i][j] : 0;
+                if (d > 0) {
+                    res = res + affine[half * i + d / 2];
+                } else if (d < 0) {
+                    res = res - affine[half * i - d / 2];
+                }
+            }
+        }
+        return res.to_affine();
+    }
+
+    // Pippenger: the scalars are cut into windows of c bits. In each window
+    // every point is added to the bucket of its digit, and the window sum
+    // sum_d d B_d is formed from running sums with 2 additions per bucket.
+    // So the cost is about (64/c)(n + 2^(c + 1)) additions instead of
+    // 64 n / (w + 1). The windows are independent and are distributed over
+    // the threads.
+    static Point pippenger(const std::vector<uint64_t>& k,
+        const std::vector<Point>& p, int num_threads = 1, int c = 0)
+    {
+        assert(k.size() == p.size());
+        assert(num_threads > 0);
+        const size_t n = k.size();
+        if (c == 0) {
+            c = pippenger_window(n);
+        }
+        assert(1 <= c && c <= 20);
+        const int windows = (64 + c - 1) / c;
+        const uint64_t mask = (uint64_t(1) << c) - 1;
+
+        std::vector<JacobianPoint> sums(windows);
+        auto window_sum = [&](int j) {
+            std::vector<JacobianPoint> buckets(mask);
+            for (size_t i = 0; i < n; ++i) {
+                const uint64_t d = (k[i] >> (c * j)) & mask;
+                if (d != 0) {
+                    buckets[d - 1] = buckets[d - 1] + p[i];
+                }
+            }
+            JacobianPoint running, sum;
+            for (size_t d = mask; d-- > 0; ) {
+                running = running + buckets[d];
+                sum = sum + running;
+            }
+            sums[j] = sum;
+        };
+
+        std::vector<std::thread> workers;
+        const int num_workers = std::min(num_threads, windows);
+        for (int t = 1; t < num_workers; ++t) {
+            workers.emplace_back([&, t]() {
+                for (int j = t; j < windows; j += num_workers) {
+                    window_sum(j);
+                }
+            });
+        }
+        for (int j = 0; j < windows; j += num_workers) {
+            window_sum(j);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        JacobianPoint res;
+        for (int j = windows - 1; j >= 0; --j) {
+            for (int i = 0; i < c; ++i) {
+                res = res.dbl();
+            }
+            res = res + sums[j];
+        }
+        return res.to_affine();
+    }
+
+    // window size minimizing (64/c)(n + 2^(c + 1))
+    static int pippenger_window(size_t n) {
+        int best = 1;
+        double best_cost = -1;
+        for (int c = 1; c <= 20; ++c) {
+            const double cost = (64 + c - 1) / c * (double(n) + double(2 << c));
+            if (best_cost < 0 || cost < best_cost) {
+                best = c;
+                best_cost = cost;
+            }
+        }
+        return best;
+    }
+
+    // Straus for few points, Pippenger for many. With 64-bit scalars over
+    // F(2^255 - 19), Pippenger is faster from about 12 points on, cf. the
+    // benchmark in ecdh.cpp.
+    static Point multi_scalar_mult(const std::vector<uint64_t>& k,
+        const std::vector<Point>& p, int num_threads = 1)
+    {
+        return k.size() < PIPPENGER_THRESHOLD
+            ? straus(k, p)
+            : pippenger(k, p, num_threads);
+    }
+
+    static constexpr size_t PIPPENGER_THRESHOLD = 12;
+
+    // Fixed-base scalar multiplication
+    //
+    // For a base point g that never changes, like the generator of a domain,
+    // all multiples j 16^i g for j = 1, ..., 8 are precomputed in affine
+    // coordinates. The scalar is recoded to signed radix 16 with digits in
+    // [-8, 8), so that ng is a sum of 17 table entries and needs neither
+    // doublings nor inversions besides the final one.
+    class FixedBase {
+    public:
+        static constexpr int DIGITS = 17;
+
+        explicit FixedBase(const Point& g) {
+            std::vector<JacobianPoint> table;
+            table.reserve(8 * DIGITS);
+            JacobianPoint row(g);  // 16^i g
+            for (int i = 0; i < DIGITS; ++i) {
+                JacobianPoint multiple = row;
+                for (int j = 1; j <= 8; ++j) {
+                    table.push_back(multiple);
+                    multiple = multiple + row;
+                }
+                row = table.back().dbl();  // 2 * 8 16^i g
+            }
+            table_ = to_affine(table);
+        }
+
+        const Point operator()(uint64_t n) const {
+            return jacobian(n).to_affine();
+        }
+
+        // without the final inversion
+        const JacobianPoint jacobian(uint64_t n) const {
+            JacobianPoint res;
+            int carry = 0;
+            for (int i = 0; i < DIGITS; ++i) {
+                int d = carry + (i < 16 ? static_cast<int>((n >> (4 * i)) & 0xF) : 0);
+                carry = d >= 8;
+                d -= 16 * carry;
+                if (d > 0) {
+                    res = res + table_[8 * i + d - 1];
+                } else if (d < 0) {
+                    res = res - table_[8 * i - d - 1];
+                }
+            }
+            return res;
+        }
+
+    private:
+        std::vector<Point> table_;  // j 16^i g at 8 i + j - 1
     };
 
     // Curve properties
@@ -200,13 +1000,17 @@ public:
         return y*y == x*x*x + a*x + F(b);
     }
 
-    // number of points (or order of the group E(F))
-    // brute force, TODO: Replace by Schoof's algorithm
-    template<typename L /* finite extension of F */ = F>
-    static size_t size() {
-        size_t count = 1;  // first point is the infinity
-        for (int64_t x = 0; x < L::size; ++x) {
-            for (int64_t y = 0; y < L::size; ++y) {
+    // number of points (or order of the group E(F)), cf. point_counting.h
+    static uint64_t size() {
+        return count_points(F(a), F(b));
+    }
+
+    // brute force over all p^2 pairs (x, y)
+    static uint64_t brute_force_size() {
+        uint64_t count = 1;  // first point is the infinity
+        const uint64_t q = F::size;
+        for (uint64_t x = 0; x < q; ++x) {
+            for (uint64_t y = 0; y < q; ++y) {
                 if (contains(x, y)) {
                     count += 1;
                 }
@@ -215,7 +1019,252 @@ public:
         return count;
     }
 
-    static_assert(F::characteristic != 2, "Char 2 is not supported");
-    static_assert(F::characteristic != 3, "Char 3 is not supported");
+    // Point compression
+    //
+    // A point is determined by x and the parity of y, since the only other
+    // point with the same x is (x, -y) and -y = p - y has the other parity.
+    // Decompression solves y^2 = x^3 + ax + b by a square root, cf. sqrt.h.
+    struct CompressedPoint {
+        bool identity;
+        F x;
+        bool odd;  // parity of y
+    };
+
+    static CompressedPoint compress(const Point& p) {
+        if (p.identity()) {
+            return {true, F(0), false};
+        }
+        return {false, p.x(), is_odd(p.y())};
+    }
+
+    // false if there is no such point
+    static bool decompress(const CompressedPoint& c, Point& p) {
+        if (c.identity) {
+            p = Point();
+            return true;
+        }
+        const auto root = field_sqrt((c.x * c.x + F(a)) * c.x + F(b));
+        if (!root.first) {
+            return false;
+        }
+        const F y = is_odd(root.second) == c.odd ? root.second : -root.second;
+        if (is_odd(y) != c.odd) {
+            return false;  // y = 0 is even
+        }
+        p = Point(c.x, y);
+        return true;
+    }
+
+    // Compressed points as bytes, to store and exchange them: x as in
+    // PointEncoding<F>, then the parity of y and a flag for the identity in
+    // the next two bits, all other bits are 0. An encoding is accepted only
+    // in this canonical form.
+    using Bytes = typename PointEncoding<F>::Bytes;
+    static constexpr int SIGN_BIT = PointEncoding<F>::bits();
+    static constexpr int IDENTITY_BIT = SIGN_BIT + 1;
+
+    static Bytes to_bytes(const CompressedPoint& c) {
+        Bytes s{};
+        if (c.identity) {
+            set_bit(s, IDENTITY_BIT);
+            return s;
+        }
+        PointEncoding<F>::store(c.x, s);
+        if (c.odd) {
+            set_bit(s, SIGN_BIT);
+        }
+        return s;
+    }
+
+    static Bytes to_bytes(const Point& p) { return to_bytes(compress(p)); }
+
+    // false for an invalid or non-canonical encoding
+    static bool from_bytes(const Bytes& s, Point& p) {
+        for (int i = IDENTITY_BIT + 1; i < int(8 * s.size()); ++i) {
+            if (get_bit(s, i)) {
+                return false;
+            }
+        }
+        CompressedPoint c{get_bit(s, IDENTITY_BIT), F(0), get_bit(s, SIGN_BIT)};
+        if (!PointEncoding<F>::load(s, c.x)) {
+            return false;
+        }
+        if (c.identity && (c.odd || c.x != F(0))) {
+            return false;
+        }
+        return decompress(c, p);
+    }
+
+    // decodes all points, split into contiguous ranges for the threads;
+    // false if any of them is invalid
+    static bool from_bytes(const std::vector<Bytes>& s,
+        std::vector<Point>& p, int num_threads = 1)
+    {
+        assert(num_threads > 0);
+        p.assign(s.size(), Point());
+        std::vector<char> valid(num_threads, true);
+        auto decode_range = [&](int t) {
+            const size_t begin = s.size() * t / num_threads;
+            const size_t end = s.size() * (t + 1) / num_threads;
+            for (size_t i = begin; i < end; ++i) {
+                valid[t] &= from_bytes(s[i], p[i]);
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (int t = 1; t < num_threads; ++t) {
+            workers.emplace_back(decode_range, t);
+        }
+        decode_range(0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        return std::all_of(valid.begin(), valid.end(), [](char v) { return v; });
+    }
+
+    // random x until there is a point, and a random sign of y
+    template<typename Gen>
+    static Point random_point(Gen& gen) {
+        Point p;
+        while (!decompress({false, PointEncoding<F>::random(gen), gen() % 2 == 1}, p)) {
+        }
+        return p;
+    }
+
+    // Order of points and of the group by baby-step giant-step
+    //
+    // By Hasse's theorem #E lies in an interval of width w = 4 sqrt(p)
+    // around p + 1. For a point P, the baby steps jP for j <= s ~ sqrt(w)
+    // and the giant steps (l + i s)P from the lower end l of the interval
+    // meet in O(p^(1/4)) group operations, and (l + i s)P = +-jP gives an m
+    // with mP = O. The order of P divides m and follows from its
+    // factorization. As soon as the lcm of the orders of a few random points
+    // has a single multiple in the interval, that multiple is #E.
+    //
+    // Mestre showed that for p > 229 this works with points of E or of its
+    // quadratic twist. The twist is no type here, so if the points of E do
+    // not suffice (e.g. E(F) = Z/n x Z/n with small n), count_points
+    // decides. Needs a characteristic p < 2^64 - 2^34, so that the Hasse
+    // interval p + 1 +- 2 sqrt(p), and thus #E, fits into 64 bits.
+    //
+    // Cf. H. Cohen, "A Course in Computational Algebraic Number Theory",
+    // algorithm 7.4.12.
+
+    // smallest n > 0 with nP = O, given m > 0 with mP = O
+    static uint64_t order(const Point& p, uint64_t m) {
+        assert(m > 0 && (m * p).identity());
+        uint64_t n = m;
+        for (uint64_t q : factor(m)) {
+            if (((n / q) * p).identity()) {
+                n /= q;
+            }
+        }
+        return n;
+    }
+
+    // some m > 0 with mP = O, from the interval [l, l + w] if the order of P
+    // is greater than s
+    static uint64_t bsgs_multiple(const Point& p, uint64_t l, uint64_t w) {
+        const uint64_t s = isqrt64(w) + 1;
+        auto key = [](const Point& q) { return static_cast<uint64_t>(q.x()()); };
+
+        // baby steps jP, j = 1, ..., s
+        std::vector<JacobianPoint> steps(s);
+        steps[0] = JacobianPoint(p);
+        for (uint64_t j = 1; j < s; ++j) {
+            steps[j] = steps[j - 1] + p;
+        }
+        const auto baby = to_affine(steps);
+        std::unordered_map<uint64_t, uint64_t> table;
+        for (uint64_t j = 0; j < s; ++j) {
+            if (baby[j].identity()) {
+                return j + 1;
+            }
+            table.emplace(key(baby[j]), j + 1);
+        }
+
+        // giant steps (l + i s)P
+        const uint64_t giants = w / s + 1;
+        steps.resize(giants);
+        steps[0] = wnaf_mult_jacobian(l, p);
+        const JacobianPoint sp(baby[s - 1]);
+        for (uint64_t i = 1; i < giants; ++i) {
+            steps[i] = steps[i - 1] + sp;
+        }
+        const auto giant = to_affine(steps);
+        for (uint64_t i = 0; i < giants; ++i) {
+            const uint64_t m = l + i * s;
+            if (giant[i].identity()) {
+                return m;
+            }
+            const auto it = table.find(key(giant[i]));
+            if (it == table.end()) {
+                continue;
+            }
+            const uint64_t j = it->second;
+            if (giant[i] == baby[j - 1]) {
+                if (m != j) {
+                    return m > j ? m - j : j - m;
+                }
+            } else {
+                return m + j;
+            }
+        }
+        assert(false);
+        return 0;
+    }
+
+    static uint64_t bsgs_size(uint64_t seed = 1) {
+        using i128 = __int128;
+        using u128 = unsigned __int128;
+        static_assert(static_cast<uint64_t>(F::characteristic)
+            < uint64_t(0) - (uint64_t(1) << 34), "#E has to fit into 64 bits");
+        const uint64_t p = static_cast<uint64_t>(F::characteristic);
+        const uint64_t r = isqrt64(p) + 1;  // > sqrt(p)
+        const uint64_t lo = p + 1 > 2 * r ? p + 1 - 2 * r : 1;
+        const uint64_t hi = p + 1 + 2 * r;
+        auto hasse = [p](uint64_t n) {
+            const i128 t = i128(n) - i128(p) - 1;
+            return t * t <= 4 * i128(p);
+        };
+
+        std::mt19937_64 gen(seed);
+        uint64_t l = 1;  // lcm of the orders of the points so far
+        for (int attempt = 0; attempt < 20; ++attempt) {
+            const Point P = random_point(gen);
+            const uint64_t n = order(P, bsgs_multiple(P, lo, hi - lo));
+            uint64_t u = l, v = n;
+            while (v != 0) {
+                const uint64_t t = u % v;
+                u = v;
+                v = t;
+            }
+            l = l / u * n;
+
+            // the multiples of l in the interval
+            uint64_t candidate = 0;
+            int count = 0;
+            // in 128 bits, since c + l may exceed 2^64
+            for (u128 c = (u128(lo) + l - 1) / l * l; c <= hi && count < 2; c += l) {
+                if (hasse(static_cast<uint64_t>(c))) {
+                    candidate = static_cast<uint64_t>(c);
+                    count += 1;
+                }
+            }
+            if (count == 1) {
+                return candidate;
+            }
+        }
+        return count_points(F(a), F(b));
+    }
+
+private:
+    static bool get_bit(const Bytes& s, int i) { return (s[i / 8] >> (i % 8)) & 1; }
+    static void set_bit(Bytes& s, int i) { s[i / 8] |= uint8_t(1) << (i % 8); }
+
+    // F(2) and F(3) instead of F::characteristic, so that F can be a field
+    // whose characteristic does not fit into an int64_t
+    static_assert(F(2) != F(0), "Char 2 is not supported");
+    static_assert(F(3) != F(0), "Char 3 is not supported");
     static_assert(discriminant() != F(0), "Discriminant is zero");
 };
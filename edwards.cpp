@@ -0,0 +1,129 @@
+#include "edwards.h"
+#include "montgomery.h"
+#include "ecdh.h"
+
+#include <catch.hpp>
+#include <array>
+#include <string>
+#include <vector>
+#include <random>
+
+
+// 32 bytes from 64 hex digits, in the same order or, if big_endian,
+// reversed into little-endian
+std::array<uint8_t, 32> from_hex(const std::string& hex, bool big_endian = false) {
+    std::array<uint8_t, 32> s{};
+    for (size_t i = 0; i < 32; ++i) {
+        s[big_endian ? 31 - i : i] =
+            static_cast<uint8_t>(std::stoi(hex.substr(2 * i, 2), nullptr, 16));
+    }
+    return s;
+}
+
+
+TEST_CASE("Unified addition on a twisted Edwards curve over F61", "[edwards]") {
+    // -1 is a square and 2 is not, since 61 = 5 mod 8, so the addition law
+    // is complete
+    using F = PF<61>;
+    using E = TwistedEdwardsCurve<F, -1, 2>;
+    using W = EllipticCurve<F, E::weierstrass_a()(), E::weierstrass_b()()>;
+
+    std::vector<E::Point> points;
+    for (int x = 0; x < 61; ++x) {
+        for (int y = 0; y < 61; ++y) {
+            if (E::contains(x, y)) {
+                points.push_back(E::Point(x, y));
+            }
+        }
+    }
+    REQUIRE(points.size() == W::size());
+
+    const E::Point O;
+    for (const auto& P : points) {
+        REQUIRE(P + O == P);
+        REQUIRE(P - P == O);
+        REQUIRE(P.dbl() == P + P);
+        REQUIRE(E::from_weierstrass<W>(E::to_weierstrass<W>(P)) == P);
+        REQUIRE(points.size() * P == O);
+
+        for (const auto& Q : points) {
+            const auto R = P + Q;
+            REQUIRE(E::contains(R.x(), R.y()));
+            REQUIRE(R == Q + P);
+            // the birational map is a group isomorphism
+            REQUIRE(E::to_weierstrass<W>(R)
+                == E::to_weierstrass<W>(P) + E::to_weierstrass<W>(Q));
+        }
+    }
+
+    for (size_t i = 0; i + 2 < points.size(); i += 3) {
+        const auto& P = points[i];
+        const auto& Q = points[i + 1];
+        const auto& R = points[i + 2];
+        REQUIRE((P + Q) + R == P + (Q + R));
+    }
+}
+
+TEST_CASE("Ed25519 base point", "[edwards][ed25519]") {
+    using F = F25519;
+    // RFC 8032, section 5.1
+    const Ed25519::Point B(
+        F::from_bytes(from_hex(
+            "216936d3cd6e53fec0a4e231fdd6dc5c692cc7609525a7b2c9562d608f25d51a",
+            true)),
+        F(4) / F(5));
+    const auto l = from_hex(
+        "1000000000000000000000000000000014def9dea2f79cd65812631a5cf5d3ed", true);
+
+    REQUIRE(Ed25519::montgomery_A() == F(486662));
+    REQUIRE(Ed25519::mult(l, 253, B).identity());
+    REQUIRE(!(uint64_t(8) * B).identity());
+
+    // u = (1 + y)/(1 - y) is the u-coordinate of X25519, u(B) = 9
+    REQUIRE(Ed25519::to_montgomery(B).first == F(9));
+    std::mt19937_64 gen(8032);
+    for (int i = 0; i < 10; ++i) {
+        const uint64_t k = gen();
+        REQUIRE(Ed25519::to_montgomery(k * B).first == Curve25519::ladder(k, F(9)));
+    }
+}
+
+TEST_CASE("Point compression on twisted Edwards curves", "[edwards]") {
+    using F = PF<61>;
+    using E = TwistedEdwardsCurve<F, -1, 2>;
+
+    int valid = 0;
+    for (int y = 0; y < 61; ++y) {
+        for (bool odd : {false, true}) {
+            E::Point p;
+            if (E::decompress({F(y), odd}, p)) {
+                REQUIRE(p.y() == F(y));
+                REQUIRE(E::compress(p).odd == odd);
+                valid += 1;
+            }
+        }
+    }
+    using W = EllipticCurve<F, E::weierstrass_a()(), E::weierstrass_b()()>;
+    REQUIRE(valid == int(W::size()));
+
+    // RFC 8032: encoding of the base point, and the public key of test 1
+    const auto b = from_hex(
+        "5866666666666666666666666666666666666666666666666666666666666666");
+    Ed25519::Point B;
+    REQUIRE(ed25519_decode(b, B));
+    REQUIRE(B.y() == F25519(4) / F25519(5));
+    REQUIRE(!is_odd(B.x()));
+    REQUIRE(ed25519_encode(B) == b);
+
+    const auto a = from_hex(
+        "d75a980182b10ab7d54bfed3c964073a0ee172f3daa62325af021a68f707511a");
+    Ed25519::Point A;
+    REQUIRE(ed25519_decode(a, A));
+    REQUIRE(ed25519_encode(A) == a);
+    REQUIRE(ed25519_encode(-A) != a);
+
+    // y = p is not canonical
+    auto p = from_hex(
+        "edffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff7f");
+    REQUIRE(!ed25519_decode(p, A));
+}
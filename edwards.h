@@ -0,0 +1,249 @@
+#pragma once
+
+#include "montgomery.h"
+#include "sqrt.h"
+
+#include <array>
+#include <ostream>
+#include <utility>
+#include <cstdint>
+#include <assert.h>
+
+//
+// Twisted Edwards curve a x^2 + y^2 = 1 + d x^2 y^2, d = d_num / d_den
+//
+// If a is a square and d is not, the addition law
+//
+//   (x1, y1) + (x2, y2) = ((x1 y2 + y1 x2) / (1 + d x1 x2 y1 y2),
+//                          (y1 y2 - a x1 x2) / (1 - d x1 x2 y1 y2))
+//
+// is complete: the denominators never vanish, the neutral element (0, 1)
+// is an ordinary point, and the same formula doubles. So there are no
+// special cases, and sequences of additions have no data-dependent
+// branches. In extended coordinates (X : Y : Z : T) with x = X/Z, y = Y/Z
+// and T = XY/Z, an addition takes 9 multiplications and no inversion.
+//
+// The curve is birationally equivalent to the Montgomery curve
+// B v^2 = u^3 + A u^2 + u with A = 2(a + d)/(a - d), B = 4/(a - d) via
+// u = (1 + y)/(1 - y), v = u/x, and thus to a short Weierstrass curve.
+//
+// Cf. H. Hisil, K. K.-H. Wong, G. Carter, E. Dawson, "Twisted Edwards curves
+// revisited", 2008, and D. J. Bernstein et al., "Twisted Edwards curves",
+// 2008.
+//
+
+template<typename F /* field of char != 2 */, int64_t a, int64_t d_num,
+    int64_t d_den = 1>
+class TwistedEdwardsCurve {
+public:
+    static constexpr F d() { return F(d_num) / F(d_den); }
+
+    static constexpr bool contains(const F& x, const F& y) {
+        return a * x * x + y * y == F(1) + d() * x * x * y * y;
+    }
+
+    class Point {
+    public:
+        // neutral element (0, 1)
+        Point() : x_(0), y_(1), z_(1), t_(0) {}
+        // affine point
+        Point(const F& x, const F& y) : x_(x), y_(y), z_(1), t_(x * y) {
+            assert(contains(x, y));
+        }
+
+        bool identity() const { return x_ == F(0) && y_ == z_; }
+        const F x() const { return x_ / z_; }
+        const F y() const { return y_ / z_; }
+
+        bool operator==(const Point& p) const {
+            return x_ * p.z_ == p.x_ * z_ && y_ * p.z_ == p.y_ * z_;
+        }
+        bool operator!=(const Point& p) const { return !(*this == p); }
+
+        // unified addition, add-2008-hwcd
+        const Point operator+(const Point& p) const {
+            const F a1 = x_ * p.x_;
+            const F b1 = y_ * p.y_;
+            const F c1 = d() * t_ * p.t_;
+            const F d1 = z_ * p.z_;
+            const F e1 = (x_ + y_) * (p.x_ + p.y_) - a1 - b1;
+            const F f1 = d1 - c1;
+            const F g1 = d1 + c1;
+            const F h1 = b1 - a * a1;
+            return Point(e1 * f1, g1 * h1, f1 * g1, e1 * h1);
+        }
+
+        // 2P, dbl-2008-hwcd, 4M + 4S
+        const Point dbl() const {
+            const F a1 = x_ * x_;
+            const F b1 = y_ * y_;
+            const F c1 = 2 * z_ * z_;
+            const F d1 = a * a1;
+            const F e1 = (x_ + y_) * (x_ + y_) - a1 - b1;
+            const F g1 = d1 + b1;
+            const F f1 = g1 - c1;
+            const F h1 = d1 - b1;
+            return Point(e1 * f1, g1 * h1, f1 * g1, e1 * h1);
+        }
+
+        const Point operator-() const { return Point(-x_, y_, z_, -t_); }
+        const Point operator-(const Point& p) const { return *this + (-p); }
+
+        friend const Point operator*(uint64_t n, const Point& p) {
+            return mult(n, 64, p);
+        }
+
+        friend std::ostream& operator<<(std::ostream& os, const Point& p) {
+            return os << "(" << p.x() << ", " << p.y() << ")";
+        }
+
+        // exchanges p and q if swap, without a branch on swap
+        friend void cswap(bool swap, Point& p, Point& q) {
+            cswap(swap, p.x_, q.x_);
+            cswap(swap, p.y_, q.y_);
+            cswap(swap, p.z_, q.z_);
+            cswap(swap, p.t_, q.t_);
+        }
+
+    private:
+        Point(const F& x, const F& y, const F& z, const F& t)
+            : x_(x), y_(y), z_(z), t_(t) {}
+
+        F x_, y_, z_, t_;
+    };
+
+    // kP from the lowest bits of k, double-and-add; every bit costs a
+    // doubling and an addition, and the sum is kept or dropped by a masked
+    // swap, so that no branch depends on k
+    template<typename Scalar>
+    static Point mult(const Scalar& k, int bits, const Point& p) {
+        Point res;
+        for (int i = bits - 1; i >= 0; --i) {
+            res = res.dbl();
+            Point sum = res + p;
+            cswap(scalar_bit(k, i), res, sum);
+        }
+        return res;
+    }
+
+    // Point compression
+    //
+    // A point is determined by y and the parity of x, since
+    // x^2 = (y^2 - 1)/(d y^2 - a), where the denominator is not 0 if d is no
+    // square and a is one.
+    struct CompressedPoint {
+        F y;
+        bool odd;  // parity of x
+    };
+
+    static CompressedPoint compress(const Point& p) {
+        return {p.y(), is_odd(p.x())};
+    }
+
+    // false if there is no such point
+    static bool decompress(const CompressedPoint& c, Point& p) {
+        const F yy = c.y * c.y;
+        const auto root = field_sqrt((yy - F(1)) / (d() * yy - F(a)));
+        if (!root.first) {
+            return false;
+        }
+        const F x = is_odd(root.second) == c.odd ? root.second : -root.second;
+        if (is_odd(x) != c.odd) {
+            return false;  // x = 0 is even
+        }
+        p = Point(x, c.y);
+        return true;
+    }
+
+    //
+    // Montgomery form B v^2 = u^3 + A u^2 + u
+    //
+
+    static constexpr F montgomery_A() { return 2 * (F(a) + d()) / (F(a) - d()); }
+    static constexpr F montgomery_B() { return F(4) / (F(a) - d()); }
+
+    // (u, v) of a point other than the neutral element, (0, -1) maps to
+    // (0, 0)
+    static std::pair<F, F> to_montgomery(const Point& p) {
+        assert(!p.identity());
+        const F x = p.x(), y = p.y();
+        if (x == F(0)) {
+            return {F(0), F(0)};
+        }
+        const F u = (F(1) + y) / (F(1) - y);
+        return {u, u / x};
+    }
+
+    static Point from_montgomery(const F& u, const F& v) {
+        if (v == F(0)) {
+            assert(u == F(0));  // only point of order 2 on the curve
+            return Point(F(0), F(-1));
+        }
+        return Point(u / v, (u - F(1)) / (u + F(1)));
+    }
+
+    //
+    // Short Weierstrass form y^2 = x^3 + a' x + b', char != 3, where
+    // x = u/B + A/3B, y = v/B
+    //
+
+    static constexpr F weierstrass_a() {
+        return (F(3) - montgomery_A() * montgomery_A())
+            / (3 * montgomery_B() * montgomery_B());
+    }
+    static constexpr F weierstrass_b() {
+        return (2 * montgomery_A() * montgomery_A() * montgomery_A()
+            - 9 * montgomery_A())
+            / (27 * montgomery_B() * montgomery_B() * montgomery_B());
+    }
+
+    // W is EllipticCurve<F, weierstrass_a(), weierstrass_b()>
+    template<typename W>
+    static typename W::Point to_weierstrass(const Point& p) {
+        if (p.identity()) {
+            return typename W::Point();
+        }
+        const auto uv = to_montgomery(p);
+        const F B = montgomery_B();
+        return typename W::Point(uv.first / B + montgomery_A() / (3 * B),
+            uv.second / B);
+    }
+
+    template<typename W>
+    static Point from_weierstrass(const typename W::Point& p) {
+        if (p.identity()) {
+            return Point();
+        }
+        const F B = montgomery_B();
+        return from_montgomery(B * p.x() - montgomery_A() / F(3), B * p.y());
+    }
+};
+
+
+//
+// Ed25519: -x^2 + y^2 = 1 - (121665/121666) x^2 y^2 over F(2^255 - 19),
+// birationally equivalent to Curve25519 with the same u = (1 + y)/(1 - y)
+// (cf. RFC 7748, section 4.1, and RFC 8032)
+//
+
+using Ed25519 = TwistedEdwardsCurve<F25519, -1, -121665, 121666>;
+
+// 32 bytes, y little-endian with the parity of x in the most significant bit
+// (RFC 8032, section 5.1.2)
+inline std::array<uint8_t, 32> ed25519_encode(const Ed25519::Point& p) {
+    const auto c = Ed25519::compress(p);
+    auto s = c.y.to_bytes();
+    s[31] |= static_cast<uint8_t>(c.odd) << 7;
+    return s;
+}
+
+// false for an invalid encoding, including y >= p (RFC 8032, section 5.1.3)
+inline bool ed25519_decode(const std::array<uint8_t, 32>& s, Ed25519::Point& p) {
+    const F25519 y = F25519::from_bytes(s);
+    auto canonical = s;
+    canonical[31] &= 0x7F;
+    if (y.to_bytes() != canonical) {
+        return false;
+    }
+    return Ed25519::decompress({y, (s[31] >> 7) == 1}, p);
+}
@@ -0,0 +1,111 @@
+#include "f25519.h"
+#include "ecdh.h"
+
+#include <catch.hpp>
+#include <array>
+#include <random>
+#include <sstream>
+
+
+std::array<uint8_t, 32> random_bytes(std::mt19937_64& gen) {
+    std::array<uint8_t, 32> s;
+    for (auto& b : s) {
+        b = static_cast<uint8_t>(gen());
+    }
+    s[31] &= 0x7F;
+    return s;
+}
+
+// p = 2^255 - 19 plus k, little-endian
+std::array<uint8_t, 32> p_plus(int k) {
+    std::array<uint8_t, 32> s;
+    s.fill(0xFF);
+    s[31] = 0x7F;
+    s[0] = static_cast<uint8_t>(0xED + k);
+    return s;
+}
+
+
+TEST_CASE("Arithmetic of small elements of F(2^255 - 19)", "[f25519]") {
+    using F = F25519;
+
+    REQUIRE(F(5) * F(7) == F(35));
+    REQUIRE(F(5) + F(7) == F(12));
+    REQUIRE(F(5) - F(7) == F(-2));
+    REQUIRE(F(-1) + F(1) == F(0));
+    REQUIRE(-F(3) == F(-3));
+    REQUIRE(F(2) * F(2).inverse() == F(1));
+    REQUIRE(F(1) / F(2) + F(1) / F(2) == F(1));
+    REQUIRE(3 * F(4) == F(12));
+    REQUIRE(F(-1) * F(-1) == F(1));
+    REQUIRE(F(0).is_zero());
+    REQUIRE(!F(1).is_zero());
+
+    // 2^255 = 19
+    F x = F(1) * F(int64_t(1) << 51);
+    REQUIRE(x * x * x * x * x == F(19));
+}
+
+TEST_CASE("Encoding of elements of F(2^255 - 19)", "[f25519]") {
+    using F = F25519;
+
+    REQUIRE(F::from_bytes(p_plus(0)) == F(0));
+    REQUIRE(F::from_bytes(p_plus(1)) == F(1));
+    REQUIRE(F::from_bytes(p_plus(-1)) == F(-1));
+    REQUIRE(F::from_bytes(p_plus(18)) == F(18));
+    REQUIRE(F::from_bytes(p_plus(0)).to_bytes() == F(0).to_bytes());
+    REQUIRE(F(-1).to_bytes() == p_plus(-1));
+
+    std::mt19937_64 gen(42);
+    for (int i = 0; i < 100; ++i) {
+        auto s = random_bytes(gen);
+        auto x = F::from_bytes(s);
+        // s >= p only happens with negligible probability
+        REQUIRE(x.to_bytes() == s);
+    }
+
+    std::ostringstream os;
+    os << F(255);
+    REQUIRE(os.str() == "0x" + std::string(62, '0') + "ff");
+}
+
+TEST_CASE("Field axioms on random elements of F(2^255 - 19)", "[f25519]") {
+    using F = F25519;
+
+    std::mt19937_64 gen(42);
+    for (int i = 0; i < 100; ++i) {
+        auto x = F::from_bytes(random_bytes(gen));
+        auto y = F::from_bytes(random_bytes(gen));
+        auto z = F::from_bytes(random_bytes(gen));
+
+        REQUIRE(x * (y + z) == x * y + x * z);
+        REQUIRE((x - y) + y == x);
+        REQUIRE(x * y == y * x);
+        REQUIRE((x * y) * z == x * (y * z));
+        REQUIRE(x * x.inverse() == F(1));
+        REQUIRE((x / y) * y == x);
+        REQUIRE(x.square(3) == x * x * x * x * x * x * x * x);
+
+        auto a = x, b = y;
+        cswap(false, a, b);
+        REQUIRE((a == x && b == y));
+        cswap(true, a, b);
+        REQUIRE((a == y && b == x));
+    }
+}
+
+TEST_CASE("Elliptic curve over F(2^255 - 19)", "[f25519][elliptic curve]") {
+    using E = EllipticCurve<F25519, 1, 4>;
+
+    // y^2 = x^3 + x + 4 contains (0, 2)
+    auto O = E::Point();
+    auto P = E::Point(0, 2);
+    auto P2 = P + P;
+    auto P3 = P2 + P;
+    REQUIRE(E::contains(P2.x(), P2.y()));
+    REQUIRE(E::contains(P3.x(), P3.y()));
+    REQUIRE(P3 - P == P2);
+    REQUIRE(P3 + P == P2 + P2);
+    REQUIRE(P - P == O);
+    REQUIRE(3 * P == P3);
+}
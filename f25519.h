@@ -0,0 +1,252 @@
+#pragma once
+
+#include <array>
+#include <ostream>
+#include <iomanip>
+#include <cstdint>
+#include <assert.h>
+
+//
+// Prime field of characteristic p = 2^255 - 19
+//
+// An element is stored in radix 2^51 as v0 + v1 2^51 + ... + v4 2^204 with
+// 64-bit limbs. Limbs are kept only loosely reduced (< 2^52), products are
+// accumulated in unsigned __int128. Since 2^255 = 19 (mod p), everything
+// above 2^255 is folded back into the lowest limb multiplied by 19.
+//
+// Cf. D. J. Bernstein, "Curve25519: new Diffie-Hellman speed records", 2006,
+// and the curve25519-donna implementation.
+//
+class F25519 {
+public:
+    static constexpr uint64_t MASK = (uint64_t(1) << 51) - 1;
+
+    constexpr F25519(int64_t a) : v_{0, 0, 0, 0, 0} {
+        const uint64_t abs = a < 0 ? ~uint64_t(a) + 1 : uint64_t(a);
+        v_[0] = abs & MASK;
+        v_[1] = abs >> 51;
+        if (a < 0) {
+            *this = negate(*this);
+        }
+    }
+
+    // little-endian, the most significant bit is ignored (cf. RFC 7748)
+    static F25519 from_bytes(const std::array<uint8_t, 32>& s) {
+        auto load64 = [&s](int i) {
+            uint64_t r = 0;
+            for (int k = 7; k >= 0; --k) {
+                r = (r << 8) | s[i + k];
+            }
+            return r;
+        };
+        return F25519(
+            load64(0) & MASK,
+            (load64(6) >> 3) & MASK,
+            (load64(12) >> 6) & MASK,
+            (load64(19) >> 1) & MASK,
+            (load64(24) >> 12) & MASK);
+    }
+
+    // little-endian encoding of the canonical representative
+    std::array<uint8_t, 32> to_bytes() const {
+        const F25519 c = canonical();
+        const uint64_t t[4] = {
+            c.v_[0] | c.v_[1] << 51,
+            c.v_[1] >> 13 | c.v_[2] << 38,
+            c.v_[2] >> 26 | c.v_[3] << 25,
+            c.v_[3] >> 39 | c.v_[4] << 12,
+        };
+        std::array<uint8_t, 32> s{};
+        for (int i = 0; i < 32; ++i) {
+            s[i] = static_cast<uint8_t>(t[i / 8] >> (8 * (i % 8)));
+        }
+        return s;
+    }
+
+    constexpr F25519 inverse() const {
+        assert(!is_zero());
+        // x^(p - 2) = (x^(2^250 - 1))^(2^5) x^11
+        const F25519 z2 = square();
+        const F25519 z11 = z2.square().square() * *this * z2;
+        return pow_2_250_minus_1().square(5) * z11;
+    }
+
+    // x^((p - 5)/8) = (x^(2^250 - 1))^4 x, for square roots
+    constexpr F25519 pow_p58() const {
+        return pow_2_250_minus_1().square(2) * *this;
+    }
+
+    constexpr F25519 operator-() const { return negate(*this); }
+
+    constexpr bool is_zero() const { return canonical() == F25519(0); }
+
+    // x^(2^k)
+    constexpr F25519 square(int k = 1) const {
+        F25519 r = *this;
+        for (int i = 0; i < k; ++i) {
+            r = r * r;
+        }
+        return r;
+    }
+
+    friend constexpr F25519 operator+(const F25519& x, const F25519& y) {
+        return F25519(
+            x.v_[0] + y.v_[0],
+            x.v_[1] + y.v_[1],
+            x.v_[2] + y.v_[2],
+            x.v_[3] + y.v_[3],
+            x.v_[4] + y.v_[4]).carry();
+    }
+
+    friend constexpr F25519 operator-(const F25519& x, const F25519& y) {
+        // add 2p to stay positive
+        return F25519(
+            x.v_[0] + 0xFFFFFFFFFFFDAULL - y.v_[0],
+            x.v_[1] + 0xFFFFFFFFFFFFEULL - y.v_[1],
+            x.v_[2] + 0xFFFFFFFFFFFFEULL - y.v_[2],
+            x.v_[3] + 0xFFFFFFFFFFFFEULL - y.v_[3],
+            x.v_[4] + 0xFFFFFFFFFFFFEULL - y.v_[4]).carry();
+    }
+
+    friend constexpr F25519 operator*(const F25519& x, const F25519& y) {
+        using u128 = unsigned __int128;
+        const uint64_t* a = x.v_;
+        const uint64_t* b = y.v_;
+        const uint64_t b1 = 19 * b[1];
+        const uint64_t b2 = 19 * b[2];
+        const uint64_t b3 = 19 * b[3];
+        const uint64_t b4 = 19 * b[4];
+
+        u128 r0 = u128(a[0]) * b[0] + u128(a[1]) * b4 + u128(a[2]) * b3
+            + u128(a[3]) * b2 + u128(a[4]) * b1;
+        u128 r1 = u128(a[0]) * b[1] + u128(a[1]) * b[0] + u128(a[2]) * b4
+            + u128(a[3]) * b3 + u128(a[4]) * b2;
+        u128 r2 = u128(a[0]) * b[2] + u128(a[1]) * b[1] + u128(a[2]) * b[0]
+            + u128(a[3]) * b4 + u128(a[4]) * b3;
+        u128 r3 = u128(a[0]) * b[3] + u128(a[1]) * b[2] + u128(a[2]) * b[1]
+            + u128(a[3]) * b[0] + u128(a[4]) * b4;
+        u128 r4 = u128(a[0]) * b[4] + u128(a[1]) * b[3] + u128(a[2]) * b[2]
+            + u128(a[3]) * b[1] + u128(a[4]) * b[0];
+
+        r1 += uint64_t(r0 >> 51);
+        r2 += uint64_t(r1 >> 51);
+        r3 += uint64_t(r2 >> 51);
+        r4 += uint64_t(r3 >> 51);
+        F25519 r(
+            uint64_t(r0) & MASK,
+            uint64_t(r1) & MASK,
+            uint64_t(r2) & MASK,
+            uint64_t(r3) & MASK,
+            uint64_t(r4) & MASK);
+        r.v_[0] += 19 * uint64_t(r4 >> 51);
+        r.v_[1] += r.v_[0] >> 51;
+        r.v_[0] &= MASK;
+        return r;
+    }
+
+    // Z-module structure
+    friend constexpr F25519 operator*(int64_t a, const F25519& y) {
+        return F25519(a) * y;
+    }
+
+    friend constexpr F25519 operator/(const F25519& x, const F25519& y) {
+        return x * y.inverse();
+    }
+
+    friend constexpr bool operator==(const F25519& x, const F25519& y) {
+        const F25519 a = x.canonical();
+        const F25519 b = y.canonical();
+        for (int i = 0; i < 5; ++i) {
+            if (a.v_[i] != b.v_[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    friend constexpr bool operator!=(const F25519& x, const F25519& y) {
+        return !(x == y);
+    }
+
+    // exchanges x and y if swap, without a branch on swap
+    friend void cswap(bool swap, F25519& x, F25519& y) {
+        const uint64_t mask = 0 - static_cast<uint64_t>(swap);
+        for (int i = 0; i < 5; ++i) {
+            const uint64_t t = mask & (x.v_[i] ^ y.v_[i]);
+            x.v_[i] ^= t;
+            y.v_[i] ^= t;
+        }
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const F25519& x) {
+        const auto s = x.to_bytes();
+        auto flags = os.flags();
+        os << "0x" << std::hex << std::setfill('0');
+        for (int i = 31; i >= 0; --i) {
+            os << std::setw(2) << static_cast<int>(s[i]);
+        }
+        os.flags(flags);
+        return os;
+    }
+
+private:
+    constexpr F25519(uint64_t v0, uint64_t v1, uint64_t v2, uint64_t v3,
+            uint64_t v4)
+        : v_{v0, v1, v2, v3, v4}
+    {}
+
+    // x^(2^250 - 1) by the addition chain from curve25519-donna, 249
+    // squarings and 10 multiplications
+    constexpr F25519 pow_2_250_minus_1() const {
+        const F25519& z = *this;
+        const F25519 z2 = z.square();
+        const F25519 z9 = z2.square().square() * z;
+        const F25519 z11 = z9 * z2;
+        const F25519 z_5_0 = z11.square() * z9;
+        const F25519 z_10_0 = z_5_0.square(5) * z_5_0;
+        const F25519 z_20_0 = z_10_0.square(10) * z_10_0;
+        const F25519 z_40_0 = z_20_0.square(20) * z_20_0;
+        const F25519 z_50_0 = z_40_0.square(10) * z_10_0;
+        const F25519 z_100_0 = z_50_0.square(50) * z_50_0;
+        const F25519 z_200_0 = z_100_0.square(100) * z_100_0;
+        return z_200_0.square(50) * z_50_0;
+    }
+
+    static constexpr F25519 negate(const F25519& x) {
+        return F25519(0, 0, 0, 0, 0) - x;
+    }
+
+    // limbs < 2^51, except v0 which gets 19 times the carry out of v4
+    constexpr F25519 carry() const {
+        F25519 r = *this;
+        for (int i = 0; i < 4; ++i) {
+            r.v_[i + 1] += r.v_[i] >> 51;
+            r.v_[i] &= MASK;
+        }
+        r.v_[0] += 19 * (r.v_[4] >> 51);
+        r.v_[4] &= MASK;
+        return r;
+    }
+
+    // unique representative in [0, p)
+    constexpr F25519 canonical() const {
+        F25519 r = carry().carry().carry();
+
+        // q = 1 iff r >= p, i.e. iff r + 19 >= 2^255
+        uint64_t q = (r.v_[0] + 19) >> 51;
+        for (int i = 1; i < 5; ++i) {
+            q = (r.v_[i] + q) >> 51;
+        }
+
+        // r - p = r + 19 - 2^255
+        r.v_[0] += 19 * q;
+        for (int i = 0; i < 4; ++i) {
+            r.v_[i + 1] += r.v_[i] >> 51;
+            r.v_[i] &= MASK;
+        }
+        r.v_[4] &= MASK;
+        return r;
+    }
+
+    uint64_t v_[5];
+};
@@ -0,0 +1,78 @@
+#include "f25519x4.h"
+
+#include <catch.hpp>
+#include <array>
+#include <vector>
+#include <random>
+
+#if F25519X4_ENABLED
+
+F25519 random_element(std::mt19937_64& gen) {
+    std::array<uint8_t, 32> s;
+    for (auto& b : s) {
+        b = static_cast<uint8_t>(gen());
+    }
+    return F25519::from_bytes(s);
+}
+
+// x op y lane by lane, for op = +, -, *, multiplication by 121665,
+// squaring 100 times, products of sums and differences, and cswap with mask
+// (0, -1, 0, -1)
+AVX2_TARGET std::vector<std::vector<F25519>> lane_results(
+    const std::vector<F25519>& a, const std::vector<F25519>& b)
+{
+    const F25519x4 x(a[0], a[1], a[2], a[3]);
+    const F25519x4 y(b[0], b[1], b[2], b[3]);
+
+    F25519x4 s = x;
+    for (int i = 0; i < 100; ++i) {
+        s = s.square();
+    }
+    F25519x4 u = x, v = y;
+    cswap(u, v, _mm256_set_epi64x(-1, 0, -1, 0));
+
+    const F25519x4 r[] = {x + y, x - y, x * y, x.mul_small(121665), s,
+        (x + y) * (x - y), (x - y).square(), u, v};
+    std::vector<std::vector<F25519>> res;
+    for (const auto& z : r) {
+        res.push_back({z.lane(0), z.lane(1), z.lane(2), z.lane(3)});
+    }
+    return res;
+}
+
+TEST_CASE("Lanes of F25519x4 agree with F25519", "[f25519][avx2]") {
+    if (!avx2_supported()) {
+        WARN("no AVX2");
+        return;
+    }
+
+    using F = F25519;
+    std::mt19937_64 gen(25519);
+    std::vector<std::vector<F>> inputs = {
+        {F(0), F(1), F(-1), F(-19)},
+        {F(-1), F(-1), F(-1), F(2)},
+    };
+    for (int i = 0; i < 50; ++i) {
+        inputs.push_back({random_element(gen), random_element(gen),
+            random_element(gen), random_element(gen)});
+    }
+
+    for (size_t t = 0; t + 1 < inputs.size(); ++t) {
+        const auto& a = inputs[t];
+        const auto& b = inputs[t + 1];
+        const auto res = lane_results(a, b);
+        for (int i = 0; i < 4; ++i) {
+            REQUIRE(res[0][i] == a[i] + b[i]);
+            REQUIRE(res[1][i] == a[i] - b[i]);
+            REQUIRE(res[2][i] == a[i] * b[i]);
+            REQUIRE(res[3][i] == 121665 * a[i]);
+            REQUIRE(res[4][i] == a[i].square(100));
+            REQUIRE(res[5][i] == (a[i] + b[i]) * (a[i] - b[i]));
+            REQUIRE(res[6][i] == (a[i] - b[i]) * (a[i] - b[i]));
+            REQUIRE(res[7][i] == (i % 2 == 1 ? b[i] : a[i]));
+            REQUIRE(res[8][i] == (i % 2 == 1 ? a[i] : b[i]));
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "f25519.h"
+
+#include <array>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+//
+// Four independent elements of F(2^255 - 19) in the lanes of AVX2 registers
+//
+// Batched computations do the same sequence of operations on many
+// independent field elements. Lane i of every register belongs to element
+// i, so one instruction does the work for all four. An element is stored in
+// radix 2^25.5, i.e. as v0 + v1 2^26 + v2 2^51 + v3 2^77 + ... + v9 2^230
+// with alternately 26 and 25 bits per limb, since AVX2 multiplies only
+// 32 x 32 -> 64 bits (vpmuludq). A product is 100 such multiplications,
+// limbs with index >= 10 are folded back multiplied by 19, and two odd
+// limbs, whose weights are 2^(25.5 k + 0.5), get an extra factor 2.
+//
+// Carrying is a chain of 12 dependent steps, about as slow as the products
+// themselves, so only products are carried. The functions are compiled for
+// AVX2 with target attributes, so the callers have to check
+// avx2_supported() first and fall back to F25519.
+//
+// Cf. T. Chou, "Sandy2x: New Curve25519 speed records", 2015, and the ref10
+// implementation of Ed25519.
+//
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define F25519X4_ENABLED 1
+#include <immintrin.h>
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define F25519X4_ENABLED 0
+#endif
+
+inline bool avx2_supported() {
+#if F25519X4_ENABLED
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+#if F25519X4_ENABLED
+class F25519x4 {
+public:
+    // the same element in all lanes
+    AVX2_TARGET explicit F25519x4(const F25519& x) : F25519x4(x, x, x, x) {}
+
+    AVX2_TARGET F25519x4(const F25519& x0, const F25519& x1, const F25519& x2,
+        const F25519& x3)
+    {
+        const std::array<uint8_t, 32> s[4] = {
+            x0.to_bytes(), x1.to_bytes(), x2.to_bytes(), x3.to_bytes()};
+        for (int k = 0; k < 10; ++k) {
+            const uint64_t mask = (uint64_t(1) << bits(k)) - 1;
+            v_[k] = _mm256_set_epi64x(
+                static_cast<int64_t>(load_bits(s[3], offset(k)) & mask),
+                static_cast<int64_t>(load_bits(s[2], offset(k)) & mask),
+                static_cast<int64_t>(load_bits(s[1], offset(k)) & mask),
+                static_cast<int64_t>(load_bits(s[0], offset(k)) & mask));
+        }
+    }
+
+    AVX2_TARGET F25519 lane(int i) const {
+        alignas(32) uint64_t limbs[10][4];
+        const F25519x4 r = carry();
+        for (int k = 0; k < 10; ++k) {
+            _mm256_store_si256(reinterpret_cast<__m256i*>(limbs[k]), r.v_[k]);
+        }
+
+        // limbs < 2^27 at their offsets, i.e. a sum < 2^257 in 32 bytes
+        // plus a carry, which is folded back as 2^256 = 38 (mod p)
+        uint64_t t[5] = {0, 0, 0, 0, 0};
+        for (int k = 0; k < 10; ++k) {
+            const int o = offset(k);
+            add_at(t, o / 64, limbs[k][i] << (o % 64));
+            if (o % 64 > 37) {
+                add_at(t, o / 64 + 1, limbs[k][i] >> (64 - o % 64));
+            }
+        }
+        std::array<uint8_t, 32> s{};
+        for (int b = 0; b < 32; ++b) {
+            s[b] = static_cast<uint8_t>(t[b / 8] >> (8 * (b % 8)));
+        }
+        // from_bytes ignores bit 255, which is worth 19
+        const uint64_t top = (t[3] >> 63) + 2 * t[4];
+        return F25519::from_bytes(s) + F25519(static_cast<int64_t>(19 * top));
+    }
+
+    // Sums and differences are not carried: if x and y are reduced, i.e.
+    // results of a multiplication or a conversion, the limbs of x + y and
+    // x - y are < 2^27.6, which is still fine as an input of a product.
+    friend AVX2_TARGET F25519x4 operator+(const F25519x4& x, const F25519x4& y) {
+        F25519x4 r;
+        for (int k = 0; k < 10; ++k) {
+            r.v_[k] = _mm256_add_epi64(x.v_[k], y.v_[k]);
+        }
+        return r;
+    }
+
+    friend AVX2_TARGET F25519x4 operator-(const F25519x4& x, const F25519x4& y) {
+        // add 2p to stay positive
+        F25519x4 r;
+        for (int k = 0; k < 10; ++k) {
+            const int64_t two_p = k == 0 ? 0x7FFFFDA : (bits(k) == 26 ? 0x7FFFFFE : 0x3FFFFFE);
+            r.v_[k] = _mm256_sub_epi64(
+                _mm256_add_epi64(x.v_[k], _mm256_set1_epi64x(two_p)), y.v_[k]);
+        }
+        return r;
+    }
+
+    friend AVX2_TARGET F25519x4 operator*(const F25519x4& x, const F25519x4& y) {
+        // 2 x_i for odd i, 19 y_j
+        __m256i x2[10], y19[10];
+        for (int k = 0; k < 10; ++k) {
+            x2[k] = k % 2 == 1 ? _mm256_add_epi64(x.v_[k], x.v_[k]) : x.v_[k];
+            y19[k] = mul19(y.v_[k]);
+        }
+
+        // fully unrolled, so that the choices below are made at compile time
+        F25519x4 r;
+#pragma GCC unroll 10
+        for (int k = 0; k < 10; ++k) {
+            __m256i h = _mm256_setzero_si256();
+#pragma GCC unroll 10
+            for (int i = 0; i < 10; ++i) {
+                const int j = (k - i + 10) % 10;
+                const __m256i a = (i % 2 == 1 && j % 2 == 1) ? x2[i] : x.v_[i];
+                const __m256i b = i > k ? y19[j] : y.v_[j];
+                h = _mm256_add_epi64(h, _mm256_mul_epu32(a, b));
+            }
+            r.v_[k] = h;
+        }
+        return r.carry();
+    }
+
+    // x_i x_j with i < j occurs twice in the product, so 55 multiplications
+    AVX2_TARGET F25519x4 square() const {
+        __m256i x2[10], x4[10], x19[10];
+        for (int k = 0; k < 10; ++k) {
+            x2[k] = _mm256_slli_epi64(v_[k], 1);
+            x4[k] = _mm256_slli_epi64(v_[k], 2);
+            x19[k] = mul19(v_[k]);
+        }
+
+        F25519x4 r;
+#pragma GCC unroll 10
+        for (int k = 0; k < 10; ++k) {
+            __m256i h = _mm256_setzero_si256();
+#pragma GCC unroll 10
+            for (int i = 0; i < 10; ++i) {
+                const int j = (k - i + 10) % 10;
+                if (j < i) {
+                    continue;
+                }
+                const int factor = (i != j ? 2 : 1) * (i % 2 == 1 && j % 2 == 1 ? 2 : 1);
+                const __m256i a = factor == 4 ? x4[i] : (factor == 2 ? x2[i] : v_[i]);
+                const __m256i b = i + j >= 10 ? x19[j] : v_[j];
+                h = _mm256_add_epi64(h, _mm256_mul_epu32(a, b));
+            }
+            r.v_[k] = h;
+        }
+        return r.carry();
+    }
+
+    // multiplication by a small constant c < 2^32
+    AVX2_TARGET F25519x4 mul_small(uint32_t c) const {
+        const __m256i m = _mm256_set1_epi64x(c);
+        F25519x4 r;
+        for (int k = 0; k < 10; ++k) {
+            r.v_[k] = _mm256_mul_epu32(v_[k], m);
+        }
+        return r.carry();
+    }
+
+    // exchanges x and y in the lanes whose mask is all ones, in constant time
+    friend AVX2_TARGET void cswap(F25519x4& x, F25519x4& y, __m256i mask) {
+        for (int k = 0; k < 10; ++k) {
+            const __m256i t = _mm256_and_si256(mask, _mm256_xor_si256(x.v_[k], y.v_[k]));
+            x.v_[k] = _mm256_xor_si256(x.v_[k], t);
+            y.v_[k] = _mm256_xor_si256(y.v_[k], t);
+        }
+    }
+
+private:
+    AVX2_TARGET F25519x4() {}
+
+    // limb k starts at bit ceil(25.5 k)
+    static constexpr int offset(int k) { return (51 * k + 1) / 2; }
+    static constexpr int bits(int k) { return k % 2 == 0 ? 26 : 25; }
+
+    // 64 bits of s starting at bit o, as far as there are bytes
+    static uint64_t load_bits(const std::array<uint8_t, 32>& s, int o) {
+        uint64_t r = 0;
+        for (int b = std::min(o / 8 + 7, 31); b >= o / 8; --b) {
+            r = (r << 8) | s[b];
+        }
+        return r >> (o % 8);
+    }
+
+    static void add_at(uint64_t* t, int i, uint64_t x) {
+        for (; x != 0 && i < 5; ++i) {
+            t[i] += x;
+            x = t[i] < x ? 1 : 0;
+        }
+    }
+
+    // 19 x = 16 x + 2 x + x, also for x >= 2^32
+    static AVX2_TARGET __m256i mul19(__m256i x) {
+        return _mm256_add_epi64(
+            _mm256_add_epi64(_mm256_slli_epi64(x, 4), _mm256_slli_epi64(x, 1)), x);
+    }
+
+    // limbs < 2^26 resp. 2^25, except v1 and v5 which may be 2^25 + 2^17;
+    // two interleaved carry chains as in ref10 halve the latency
+    AVX2_TARGET F25519x4 carry() const {
+        F25519x4 r = *this;
+        auto carry_from = [&r](int k) AVX2_TARGET {
+            const __m256i mask = _mm256_set1_epi64x((int64_t(1) << bits(k)) - 1);
+            const __m256i c = _mm256_srli_epi64(r.v_[k], bits(k));
+            r.v_[k] = _mm256_and_si256(r.v_[k], mask);
+            if (k < 9) {
+                r.v_[k + 1] = _mm256_add_epi64(r.v_[k + 1], c);
+            } else {
+                r.v_[0] = _mm256_add_epi64(r.v_[0], mul19(c));
+            }
+        };
+        for (int k = 0; k < 5; ++k) {
+            carry_from(k);
+            carry_from(k + 4);
+        }
+        carry_from(9);
+        carry_from(0);
+        return r;
+    }
+
+    __m256i v_[10];
+};
+#endif
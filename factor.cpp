@@ -0,0 +1,57 @@
+#include "factor.h"
+
+#include <catch.hpp>
+#include <vector>
+#include <random>
+
+
+TEST_CASE("Miller-Rabin agrees with a sieve", "[factor]") {
+    const uint64_t n = 100000;
+    std::vector<bool> sieve(n, true);
+    sieve[0] = sieve[1] = false;
+    for (uint64_t i = 2; i * i < n; ++i) {
+        if (sieve[i]) {
+            for (uint64_t j = i * i; j < n; j += i) {
+                sieve[j] = false;
+            }
+        }
+    }
+    for (uint64_t i = 0; i < n; ++i) {
+        REQUIRE(is_prime64(i) == sieve[i]);
+    }
+
+    REQUIRE(is_prime64((uint64_t(1) << 61) - 1));
+    REQUIRE(is_prime64(uint64_t(-59)));
+    REQUIRE(!is_prime64(uint64_t(-1)));
+    // strong pseudoprime to the bases 2, 3, ..., 23
+    REQUIRE(!is_prime64(3825123056546413051ULL));
+    // Carmichael number
+    REQUIRE(!is_prime64(561));
+}
+
+TEST_CASE("Factorization of 64-bit integers", "[factor]") {
+    REQUIRE(factor(1).empty());
+    REQUIRE(factor(2) == std::vector<uint64_t>{2});
+    REQUIRE(factor(360) == (std::vector<uint64_t>{2, 2, 2, 3, 3, 5}));
+    REQUIRE(factor(uint64_t(-1)) ==
+        (std::vector<uint64_t>{3, 5, 17, 257, 641, 65537, 6700417}));
+    // two 32-bit primes, and the square of one
+    REQUIRE(factor(4294967291ULL * 4294967279ULL) ==
+        (std::vector<uint64_t>{4294967279ULL, 4294967291ULL}));
+    REQUIRE(factor(4294967291ULL * 4294967291ULL) ==
+        (std::vector<uint64_t>{4294967291ULL, 4294967291ULL}));
+
+    std::mt19937_64 gen(48);
+    for (int i = 0; i < 200; ++i) {
+        const uint64_t n = gen() >> (gen() % 40);
+        if (n == 0) {
+            continue;
+        }
+        uint64_t product = 1;
+        for (uint64_t q : factor(n)) {
+            REQUIRE(is_prime64(q));
+            product *= q;
+        }
+        REQUIRE(product == n);
+    }
+}
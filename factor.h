@@ -0,0 +1,154 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <assert.h>
+
+//
+// Primality and factorization of 64-bit integers
+//
+// Miller-Rabin with the first 12 primes as bases is deterministic below
+// 3.3 * 10^24, so in particular for all 64-bit n. Factors are split off by
+// trial division up to 2^10 and then by Pollard's rho in Brent's variant,
+// which finds a factor q in about sqrt(q) steps, i.e. in at most 2^16 steps
+// for 64-bit n.
+//
+// Cf. R. P. Brent, "An improved Monte Carlo factorization algorithm", 1980,
+// and J. Sorenson, J. Webster, "Strong pseudoprimes to twelve prime bases",
+// 2017.
+//
+
+inline uint64_t mul_mod64(uint64_t a, uint64_t b, uint64_t m) {
+    return static_cast<uint64_t>((unsigned __int128)a * b % m);
+}
+
+inline uint64_t pow_mod64(uint64_t base, uint64_t e, uint64_t m) {
+    uint64_t res = 1 % m;
+    for (base %= m; e > 0; e >>= 1, base = mul_mod64(base, base, m)) {
+        if (e & 1) {
+            res = mul_mod64(res, base, m);
+        }
+    }
+    return res;
+}
+
+// floor(sqrt(n))
+inline uint64_t isqrt64(uint64_t n) {
+    uint64_t r = static_cast<uint64_t>(std::sqrt(static_cast<long double>(n)));
+    while (r > 0 && (unsigned __int128)r * r > n) {
+        r -= 1;
+    }
+    while ((unsigned __int128)(r + 1) * (r + 1) <= n) {
+        r += 1;
+    }
+    return r;
+}
+
+inline bool is_prime64(uint64_t n) {
+    static const uint64_t bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+    if (n < 2) {
+        return false;
+    }
+    for (uint64_t q : bases) {
+        if (n % q == 0) {
+            return n == q;
+        }
+    }
+
+    // n - 1 = d 2^s
+    uint64_t d = n - 1;
+    int s = 0;
+    while (d % 2 == 0) {
+        d /= 2;
+        s += 1;
+    }
+    for (uint64_t a : bases) {
+        uint64_t x = pow_mod64(a, d, n);
+        if (x == 1 || x == n - 1) {
+            continue;
+        }
+        bool witness = true;
+        for (int i = 1; i < s && witness; ++i) {
+            x = mul_mod64(x, x, n);
+            witness = x != n - 1;
+        }
+        if (witness) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// a non-trivial factor of the odd composite n
+inline uint64_t pollard_brent(uint64_t n) {
+    auto gcd = [](uint64_t a, uint64_t b) {
+        while (b != 0) {
+            const uint64_t t = a % b;
+            a = b;
+            b = t;
+        }
+        return a;
+    };
+
+    // iteration x -> x^2 + c, the product of 128 differences is taken
+    // before each gcd
+    for (uint64_t c = 1; ; ++c) {
+        auto f = [n, c](uint64_t x) { return (mul_mod64(x, x, n) + c) % n; };
+        uint64_t y = 2, x = y, ys = y, q = 1, g = 1;
+        for (uint64_t r = 1; g == 1; r *= 2) {
+            x = y;
+            for (uint64_t i = 0; i < r; ++i) {
+                y = f(y);
+            }
+            for (uint64_t k = 0; k < r && g == 1; k += 128) {
+                ys = y;
+                for (uint64_t i = 0; i < std::min<uint64_t>(128, r - k); ++i) {
+                    y = f(y);
+                    q = mul_mod64(q, x > y ? x - y : y - x, n);
+                }
+                g = gcd(q, n);
+            }
+        }
+        if (g == n) {
+            // the batch overshot, redo it step by step
+            do {
+                ys = f(ys);
+                g = gcd(x > ys ? x - ys : ys - x, n);
+            } while (g == 1);
+        }
+        if (g != n) {
+            return g;
+        }
+    }
+}
+
+// prime factors with multiplicity, in increasing order
+inline std::vector<uint64_t> factor(uint64_t n) {
+    assert(n > 0);
+    std::vector<uint64_t> res;
+    for (uint64_t q = 2; q < 1024 && q * q <= n; q += 1 + (q > 2)) {
+        while (n % q == 0) {
+            res.push_back(q);
+            n /= q;
+        }
+    }
+
+    std::vector<uint64_t> stack{n};
+    while (!stack.empty()) {
+        const uint64_t m = stack.back();
+        stack.pop_back();
+        if (m == 1) {
+            continue;
+        } else if (is_prime64(m)) {
+            res.push_back(m);
+        } else {
+            const uint64_t d = pollard_brent(m);
+            stack.push_back(d);
+            stack.push_back(m / d);
+        }
+    }
+    std::sort(res.begin(), res.end());
+    return res;
+}
@@ -0,0 +1,95 @@
+#include "inversions.h"
+#include "johnson_trotter.h"
+#include "next_permutation.h"
+
+#include <catch.hpp>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+
+uint64_t count_inversions_naive(const std::vector<int>& seq) {
+    uint64_t inversions = 0;
+    for (size_t i = 0; i < seq.size(); ++i) {
+        for (size_t j = i + 1; j < seq.size(); ++j) {
+            if (seq[i] > seq[j]) {
+                inversions += 1;
+            }
+        }
+    }
+    return inversions;
+}
+
+
+TEST_CASE("Sign via cycles of small permutations", "[sign]") {
+    std::vector<int> seq;
+    REQUIRE(sgn_cycles(seq.begin(), seq.end()) == 1);
+
+    for (int n = 1; n < 7; ++n) {
+        seq.resize(n);
+        for (int i = 0; i < n; ++i) {
+            seq[i] = i;
+        }
+        do {
+            REQUIRE(sgn_cycles(seq.begin(), seq.end()) ==
+                sgn(seq.begin(), seq.end()));
+        } while (next_permutation(seq));
+    }
+}
+
+TEST_CASE("Count inversions of small permutations", "[inversions]") {
+    std::vector<int> seq = {0, 1, 2, 3, 4, 5, 6};
+    do {
+        auto expected = count_inversions_naive(seq);
+        REQUIRE(count_inversions_merge(seq.begin(), seq.end()) == expected);
+        REQUIRE(count_inversions_fenwick(seq.begin(), seq.end()) == expected);
+    } while (next_permutation(seq));
+
+    std::vector<int> reversed = {6, 5, 4, 3, 2, 1, 0};
+    REQUIRE(count_inversions_merge(reversed.begin(), reversed.end()) == 21);
+    REQUIRE(count_inversions_fenwick(reversed.begin(), reversed.end()) == 21);
+}
+
+TEST_CASE("Sign and inversions of a large permutation", "[inversions]") {
+    const int n = 1000000;
+    std::vector<int> seq(n);
+    for (int i = 0; i < n; ++i) {
+        seq[i] = i;
+    }
+    std::mt19937 gen(42);
+    std::shuffle(seq.begin(), seq.end(), gen);
+
+    auto merge = count_inversions_merge(seq.begin(), seq.end());
+    auto fenwick = count_inversions_fenwick(seq.begin(), seq.end());
+    REQUIRE(merge == fenwick);
+    REQUIRE(sgn_cycles(seq.begin(), seq.end()) == (merge % 2 == 0 ? 1 : -1));
+
+    // reversing swaps inversions and non-inversions
+    std::reverse(seq.begin(), seq.end());
+    REQUIRE(count_inversions_fenwick(seq.begin(), seq.end()) ==
+        uint64_t(n) * (n - 1) / 2 - merge);
+}
+
+TEST_CASE("Track parity while generating permutations", "[parity]") {
+    std::vector<int> seq = {0, 1, 2, 3, 4, 5};
+    ParityTracker parity;
+    while (johnson_trotter(seq)) {
+        parity.transposition();
+        REQUIRE(parity.sign() == sgn_cycles(seq.begin(), seq.end()));
+    }
+
+    ParityTracker swaps(sgn_cycles(seq.begin(), seq.end()));
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<size_t> dis(0, seq.size() - 1);
+    for (int k = 0; k < 100; ++k) {
+        swaps.swap(seq, dis(gen), dis(gen));
+        REQUIRE(swaps.sign() == sgn_cycles(seq.begin(), seq.end()));
+    }
+
+    for (size_t k = 0; k <= seq.size(); ++k) {
+        ParityTracker reversal(sgn_cycles(seq.begin(), seq.end()));
+        std::reverse(seq.begin(), seq.begin() + k);
+        reversal.reversal(k);
+        REQUIRE(reversal.sign() == sgn_cycles(seq.begin(), seq.end()));
+    }
+}
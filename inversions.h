@@ -0,0 +1,144 @@
+#pragma once
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <assert.h>
+
+//
+// Sign and inversions of large permutations
+//
+// The naive sgn in johnson_trotter.h is O(n^2). The functions here assume
+// seq == {0, ..., n - 1} as set, like the generators.
+//
+
+// O(n): sgn = (-1)^(n - number of cycles)
+template<typename Iter>
+int sgn_cycles(Iter begin, Iter end) {
+    const size_t n = std::distance(begin, end);
+    std::vector<bool> visited(n, false);
+
+    size_t transpositions = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (visited[i]) {
+            continue;
+        }
+        // walk the cycle containing i; a cycle of length k is a product of
+        // k - 1 transpositions
+        size_t j = i;
+        while (!visited[j]) {
+            visited[j] = true;
+            j = static_cast<size_t>(*(begin + j));
+            assert(j < n);
+            transpositions += 1;
+        }
+        transpositions -= 1;
+    }
+    return transpositions % 2 == 0 ? 1 : -1;
+}
+
+
+// O(n log n): bottom-up merge sort counting the pairs crossing each merge
+template<typename Iter>
+uint64_t count_inversions_merge(Iter begin, Iter end) {
+    using T = typename std::iterator_traits<Iter>::value_type;
+    std::vector<T> a(begin, end);
+    std::vector<T> b(a.size());
+    const size_t n = a.size();
+
+    uint64_t inversions = 0;
+    for (size_t width = 1; width < n; width *= 2) {
+        for (size_t lo = 0; lo < n; lo += 2 * width) {
+            const size_t mid = std::min(lo + width, n);
+            const size_t hi = std::min(lo + 2 * width, n);
+            size_t i = lo, j = mid, k = lo;
+            while (i < mid && j < hi) {
+                if (a[j] < a[i]) {
+                    // a[j] is smaller than all of a[i, mid)
+                    inversions += mid - i;
+                    b[k++] = a[j++];
+                } else {
+                    b[k++] = a[i++];
+                }
+            }
+            while (i < mid) {
+                b[k++] = a[i++];
+            }
+            while (j < hi) {
+                b[k++] = a[j++];
+            }
+        }
+        std::swap(a, b);
+    }
+    return inversions;
+}
+
+
+// O(n log n): scan from the right and count the smaller values seen so far
+// in a Fenwick (binary indexed) tree
+template<typename Iter>
+uint64_t count_inversions_fenwick(Iter begin, Iter end) {
+    const size_t n = std::distance(begin, end);
+    std::vector<uint32_t> tree(n + 1, 0);
+
+    uint64_t inversions = 0;
+    for (auto it = end; it != begin;) {
+        --it;
+        const size_t v = static_cast<size_t>(*it);
+        assert(v < n);
+
+        // number of values in [0, v)
+        for (size_t i = v; i > 0; i -= i & (~i + 1)) {
+            inversions += tree[i];
+        }
+        // add v
+        for (size_t i = v + 1; i <= n; i += i & (~i + 1)) {
+            tree[i] += 1;
+        }
+    }
+    return inversions;
+}
+
+
+//
+// Parity tracker
+//
+// Keeps the sign of a permutation while a generator modifies it. Every
+// transposition flips the sign, so each update is O(1) instead of
+// recomputing the sign from scratch.
+//
+class ParityTracker {
+public:
+    explicit ParityTracker(int sign = 1) : sign_(sign) {
+        assert(sign == 1 || sign == -1);
+    }
+
+    int sign() const { return sign_; }
+
+    // the permutation was changed by a single transposition, e.g. a step of
+    // johnson_trotter
+    void transposition() { sign_ = -sign_; }
+
+    // the permutation was changed by reversing k consecutive elements, e.g.
+    // the suffix reversal in next_permutation
+    void reversal(size_t k) {
+        if ((k / 2) % 2 == 1) {
+            sign_ = -sign_;
+        }
+    }
+
+    // swap seq[i] and seq[j] and update the sign
+    template<typename T>
+    void swap(std::vector<T>& seq, size_t i, size_t j) {
+        if (i != j) {
+            std::swap(seq[i], seq[j]);
+            transposition();
+        }
+    }
+
+private:
+    int sign_;
+};
@@ -0,0 +1,156 @@
+#include "montgomery.h"
+#include "ecdh.h"
+
+#include <catch.hpp>
+#include <array>
+#include <string>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <iostream>
+
+
+std::array<uint8_t, 32> from_hex(const std::string& hex) {
+    std::array<uint8_t, 32> s{};
+    for (size_t i = 0; i < 32; ++i) {
+        s[i] = static_cast<uint8_t>(std::stoi(hex.substr(2 * i, 2), nullptr, 16));
+    }
+    return s;
+}
+
+
+TEST_CASE("Montgomery ladder agrees with Weierstrass arithmetic over F71",
+    "[montgomery]")
+{
+    using F = PF<71>;
+    // y^2 = x^3 + 486662 x^2 + x is birationally equivalent to
+    // y^2 = x^3 + a x + b with a = (3 - A^2)/3, b = (2A^3 - 9A)/27, i.e.
+    // (x, y) -> (x + A/3, y)
+    using M = MontgomeryCurve<F, 486662>;
+    using W = EllipticCurve<F, 0, 60>;
+    const F shift = F(486662) / F(3);
+
+    auto P = W::Point(F(1) + shift, 32);
+    auto Q = P;
+    for (uint64_t k = 1; k < 80; ++k) {
+        if (!Q.identity()) {
+            REQUIRE(M::ladder(k, F(1)) == Q.x() - shift);
+        }
+        Q = Q + P;
+    }
+
+    // Diffie-Hellman
+    for (uint64_t a = 1; a < 20; ++a) {
+        for (uint64_t b = 1; b < 20; ++b) {
+            REQUIRE(M::ladder(a, M::ladder(b, F(4))) ==
+                M::ladder(b, M::ladder(a, F(4))));
+        }
+    }
+}
+
+TEST_CASE("X25519 test vectors of RFC 7748", "[montgomery][x25519]") {
+    REQUIRE(x25519(
+        from_hex("a546e36bf0527c9d3b16154b82465edd62144c0ac1fc5a18506a2244ba449ac4"),
+        from_hex("e6db6867583030db3594c1a424b15f7c726624ec26b3353b10a903a6d0ab1c4c")) ==
+        from_hex("c3da55379de9c6908e94ea4df28d084f32eccf03491c71f754b4075577a28552"));
+
+    // iterated: k, u <- x25519(k, u), k
+    auto k = x25519_base_point();
+    auto u = x25519_base_point();
+    for (int i = 0; i < 1000; ++i) {
+        auto r = x25519(k, u);
+        u = k;
+        k = r;
+        if (i == 0) {
+            REQUIRE(k == from_hex(
+                "422c8e7a6227d7bca1350b3e2bb7279f7897b87bb6854b783c60e80311ae3079"));
+        }
+    }
+    REQUIRE(k == from_hex(
+        "684cf59ba83309552800ef566f2f4d3c1c3887c49360e3875f2eb94d99532c51"));
+}
+
+TEST_CASE("X25519 key exchange of RFC 7748", "[montgomery][x25519]") {
+    auto alice_priv = from_hex(
+        "77076d0a7318a57d3c16c17251b26645df4c2f87ebc0992ab177fba51db92c2a");
+    auto bob_priv = from_hex(
+        "5dab087e624a8a4b79e17f8b83800ee66f3bb1292618b6fd1c2f8b27ff88e0eb");
+
+    auto alice_pub = x25519(alice_priv, x25519_base_point());
+    auto bob_pub = x25519(bob_priv, x25519_base_point());
+    REQUIRE(alice_pub == from_hex(
+        "8520f0098930a754748b7ddcb43ef75a0dbf3a0d26381af4eba4a98eaa9b4e6a"));
+    REQUIRE(bob_pub == from_hex(
+        "de9edb7d7b7dc1b4d35b61c2ece435373f8343c85b78674dadfc7e146f882b4f"));
+
+    auto shared = from_hex(
+        "4a5d9d5ba4ce2de1728e3bf480350f25e07e21c947d19e3376f09b3c1e161742");
+    REQUIRE(x25519(alice_priv, bob_pub) == shared);
+    REQUIRE(x25519(bob_priv, alice_pub) == shared);
+}
+
+TEST_CASE("Batched X25519 agrees with X25519", "[montgomery][x25519]") {
+    std::mt19937_64 gen(7748);
+    auto random_bytes = [&gen]() {
+        std::array<uint8_t, 32> s;
+        for (auto& b : s) {
+            b = static_cast<uint8_t>(gen());
+        }
+        return s;
+    };
+
+    // sizes with and without a remainder modulo 4 lanes
+    for (size_t n : {0, 1, 4, 11}) {
+        std::vector<std::array<uint8_t, 32>> k, u;
+        for (size_t i = 0; i < n; ++i) {
+            k.push_back(random_bytes());
+            u.push_back(i % 3 == 0 ? x25519_base_point() : random_bytes());
+        }
+        const auto r = x25519_batch(k, u);
+        REQUIRE(r.size() == n);
+        for (size_t i = 0; i < n; ++i) {
+            REQUIRE(r[i] == x25519(k[i], u[i]));
+        }
+    }
+
+    // u = 0 is a point of small order
+    const std::vector<std::array<uint8_t, 32>> zero(4, std::array<uint8_t, 32>{});
+    REQUIRE(x25519_batch(zero, zero) == zero);
+}
+
+TEST_CASE("X25519 throughput", "[.][benchmark][x25519]") {
+    auto k = x25519_base_point();
+    auto u = x25519_base_point();
+
+    const int n = 2000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; ++i) {
+        auto r = x25519(k, u);
+        u = k;
+        k = r;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double> elapsed = end - start;
+    std::cout << "x25519: " << n / elapsed.count() << " ops/s" << std::endl;
+    REQUIRE(k != u);
+}
+
+TEST_CASE("Batched X25519 throughput", "[.][benchmark][x25519]") {
+    std::mt19937_64 gen(42);
+    const size_t n = 2000;
+    std::vector<std::array<uint8_t, 32>> k(n), u(n, x25519_base_point());
+    for (auto& s : k) {
+        for (auto& b : s) {
+            b = static_cast<uint8_t>(gen());
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    const auto r = x25519_batch(k, u);
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    std::cout << "x25519, batched" << (avx2_supported() ? " (AVX2)" : "") << ": "
+        << n / elapsed.count() << " ops/s" << std::endl;
+    REQUIRE(r[0] == x25519(k[0], u[0]));
+}
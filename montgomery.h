@@ -0,0 +1,195 @@
+#pragma once
+
+#include "f25519.h"
+#include "f25519x4.h"
+
+#include <array>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <assert.h>
+
+//
+// Montgomery curve y^2 = x^3 + A x^2 + x
+//
+// Scalar multiplication needs only the x-coordinate: the Montgomery ladder
+// keeps x(nP) and x((n + 1)P) in projective coordinates (X : Z) and does one
+// differential addition and one doubling per bit of the scalar. The only
+// inversion happens at the very end.
+//
+// Cf. P. L. Montgomery, "Speeding the Pollard and elliptic curve methods of
+// factorization", 1987, and RFC 7748.
+//
+
+// bit i of a scalar
+inline bool scalar_bit(uint64_t k, int i) {
+    return i < 64 && ((k >> i) & 1);
+}
+
+template<size_t N>
+bool scalar_bit(const std::array<uint8_t, N>& k, int i) {
+    return (k[i / 8] >> (i % 8)) & 1;
+}
+
+
+// exchanges x and y if swap, without a branch on swap, for fields whose
+// representation is not accessible; F25519 has its own with masks
+template<typename F>
+void cswap(bool swap, F& x, F& y) {
+    const F t = F(static_cast<int64_t>(swap)) * (x - y);
+    x = x - t;
+    y = y + t;
+}
+
+template<typename F, int64_t A>
+class MontgomeryCurve {
+public:
+    // x(kP) from x(P), using the lowest bits of k. If kP is the point at
+    // infinity, 0 is returned (as in RFC 7748).
+    template<typename Scalar>
+    static F ladder(const Scalar& k, int bits, const F& x) {
+        // (A - 2) / 4
+        static const F a24 = F(A - 2) / F(4);
+
+        F x2 = 1, z2 = 0;  // nP
+        F x3 = x, z3 = 1;  // (n + 1)P
+        bool swap = false;
+        for (int t = bits - 1; t >= 0; --t) {
+            const bool bit = scalar_bit(k, t);
+            swap ^= bit;
+            cswap(swap, x2, x3);
+            cswap(swap, z2, z3);
+            swap = bit;
+
+            const F a = x2 + z2;
+            const F aa = a * a;
+            const F b = x2 - z2;
+            const F bb = b * b;
+            const F e = aa - bb;
+            const F c = x3 + z3;
+            const F d = x3 - z3;
+            const F da = d * a;
+            const F cb = c * b;
+
+            // differential addition: x((2n + 1)P) from nP, (n + 1)P and P
+            x3 = (da + cb) * (da + cb);
+            z3 = x * (da - cb) * (da - cb);
+            // doubling: x(2nP)
+            x2 = aa * bb;
+            z2 = e * (aa + a24 * e);
+        }
+        cswap(swap, x2, x3);
+        cswap(swap, z2, z3);
+
+        if (z2 == F(0)) {
+            return F(0);
+        }
+        return x2 / z2;
+    }
+
+    static F ladder(uint64_t k, const F& x) { return ladder(k, 64, x); }
+};
+
+
+//
+// X25519 (RFC 7748)
+//
+
+using Curve25519 = MontgomeryCurve<F25519, 486662>;
+
+// base point u = 9
+inline std::array<uint8_t, 32> x25519_base_point() {
+    std::array<uint8_t, 32> u{};
+    u[0] = 9;
+    return u;
+}
+
+// multiple of the cofactor 8, bit 254 set
+inline std::array<uint8_t, 32> x25519_clamp(std::array<uint8_t, 32> k) {
+    k[0] &= 248;
+    k[31] &= 127;
+    k[31] |= 64;
+    return k;
+}
+
+// Diffie-Hellman function: scalar multiplication of the point with
+// u-coordinate u by the clamped scalar k
+inline std::array<uint8_t, 32> x25519(const std::array<uint8_t, 32>& k,
+    const std::array<uint8_t, 32>& u)
+{
+    return Curve25519::ladder(x25519_clamp(k), 255, F25519::from_bytes(u)).to_bytes();
+}
+
+#if F25519X4_ENABLED
+// x25519(k[i], u[i]) for i = 0, ..., 3, the ladder above with one key
+// exchange per lane; the swaps depend on the bits of four scalars, so they
+// are done with masks
+AVX2_TARGET inline void x25519_x4(const std::array<uint8_t, 32>* k,
+    const std::array<uint8_t, 32>* u, std::array<uint8_t, 32>* res)
+{
+    std::array<uint8_t, 32> c[4];
+    for (int i = 0; i < 4; ++i) {
+        c[i] = x25519_clamp(k[i]);
+    }
+
+    const F25519x4 x(F25519::from_bytes(u[0]), F25519::from_bytes(u[1]),
+        F25519::from_bytes(u[2]), F25519::from_bytes(u[3]));
+    F25519x4 x2(F25519(1)), z2(F25519(0));  // nP
+    F25519x4 x3 = x, z3(F25519(1));         // (n + 1)P
+    __m256i swap = _mm256_setzero_si256();
+    for (int t = 254; t >= 0; --t) {
+        const __m256i bit = _mm256_set_epi64x(-int64_t(scalar_bit(c[3], t)),
+            -int64_t(scalar_bit(c[2], t)), -int64_t(scalar_bit(c[1], t)),
+            -int64_t(scalar_bit(c[0], t)));
+        swap = _mm256_xor_si256(swap, bit);
+        cswap(x2, x3, swap);
+        cswap(z2, z3, swap);
+        swap = bit;
+
+        const F25519x4 a = x2 + z2;
+        const F25519x4 aa = a.square();
+        const F25519x4 b = x2 - z2;
+        const F25519x4 bb = b.square();
+        const F25519x4 e = aa - bb;
+        const F25519x4 c = x3 + z3;
+        const F25519x4 d = x3 - z3;
+        const F25519x4 da = d * a;
+        const F25519x4 cb = c * b;
+
+        x3 = (da + cb).square();
+        z3 = x * (da - cb).square();
+        x2 = aa * bb;
+        z2 = e * (aa + e.mul_small(121665));  // (A - 2)/4 = 121665
+    }
+    cswap(x2, x3, swap);
+    cswap(z2, z3, swap);
+
+    for (int i = 0; i < 4; ++i) {
+        const F25519 z = z2.lane(i);
+        res[i] = (z == F25519(0) ? F25519(0) : x2.lane(i) / z).to_bytes();
+    }
+}
+#endif
+
+// x25519(k[i], u[i]) for all i, four at a time in the lanes of AVX2
+// registers if the processor has them
+inline std::vector<std::array<uint8_t, 32>> x25519_batch(
+    const std::vector<std::array<uint8_t, 32>>& k,
+    const std::vector<std::array<uint8_t, 32>>& u)
+{
+    assert(k.size() == u.size());
+    std::vector<std::array<uint8_t, 32>> res(k.size());
+    size_t i = 0;
+#if F25519X4_ENABLED
+    if (avx2_supported()) {
+        for (; i + 4 <= k.size(); i += 4) {
+            x25519_x4(&k[i], &u[i], &res[i]);
+        }
+    }
+#endif
+    for (; i < k.size(); ++i) {
+        res[i] = x25519(k[i], u[i]);
+    }
+    return res;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+
+
+// https://en.wikipedia.org/wiki/Permutation#Generation_in_lexicographic_order
+// Works also for multisets
+template<typename T>
+bool next_permutation(std::vector<T>& seq) {
+    // trivial cases
+    if (seq.size() < 2) {
+        return false;
+    }
+
+    // find pivot
+    int i = seq.size() - 1;
+    while (i > 0 && seq[i - 1] >= seq[i]) {
+        i--;
+    }
+
+    // last permutation
+    if (i == 0) {
+        return false;
+    }
+
+    // find right most element greater than pivot
+    int j = seq.size() - 1;
+    while (seq[j] <= seq[i - 1]) {
+        j--;
+    }
+    std::swap(seq[i - 1], seq[j]);
+
+    // sort suffix <=> reverse suffix
+    j = seq.size() - 1;
+    while (i < j) {
+        std::swap(seq[i], seq[j]);
+        i++;
+        j--;
+    }
+
+    return true;
+}
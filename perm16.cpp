@@ -0,0 +1,131 @@
+#include "perm16.h"
+#include "next_permutation.h"
+#include "johnson_trotter.h"
+
+#include <catch.hpp>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+
+std::vector<int> random_permutation(int n, std::mt19937& gen) {
+    std::vector<int> seq(n);
+    for (int i = 0; i < n; ++i) {
+        seq[i] = i;
+    }
+    std::shuffle(seq.begin(), seq.end(), gen);
+    return seq;
+}
+
+
+TEST_CASE("Pack and unpack permutations", "[perm16]") {
+    REQUIRE(Perm16().to_vector() == (std::vector<int>{}));
+    REQUIRE(Perm16(3).to_vector() == (std::vector<int>{0, 1, 2}));
+
+    std::vector<int> seq = {2, 0, 3, 1};
+    Perm16 p(seq);
+    REQUIRE(p.size() == 4);
+    REQUIRE(p.word() == 0xFEDCBA9876541302ULL);
+    REQUIRE(p.to_vector() == seq);
+
+    p.swap(0, 3);
+    REQUIRE(p.to_vector() == (std::vector<int>{1, 0, 3, 2}));
+}
+
+TEST_CASE("Compose and invert packed permutations", "[perm16]") {
+    std::mt19937 gen(42);
+    for (int n = 0; n <= Perm16::MAX_SIZE; ++n) {
+        auto seq_p = random_permutation(n, gen);
+        auto seq_q = random_permutation(n, gen);
+        Perm16 p(seq_p), q(seq_q);
+
+        std::vector<int> pq(n);
+        for (int i = 0; i < n; ++i) {
+            pq[i] = seq_p[seq_q[i]];
+        }
+        REQUIRE(compose(p, q).to_vector() == pq);
+        REQUIRE(compose(p, inverse(p)) == Perm16(n));
+        REQUIRE(compose(inverse(p), p) == Perm16(n));
+        REQUIRE(inverse(inverse(p)) == p);
+    }
+}
+
+TEST_CASE("Composition by pshufb agrees with the nibble loop", "[perm16]") {
+#if PERM16_SSSE3_ENABLED
+    if (!ssse3_supported()) {
+        return;
+    }
+    std::mt19937 gen(7);
+    for (int k = 0; k < 1000; ++k) {
+        const int n = k % (Perm16::MAX_SIZE + 1);
+        const Perm16 p(random_permutation(n, gen));
+        const Perm16 q(random_permutation(n, gen));
+        REQUIRE(compose_ssse3(p, q) == compose_nibbles(p, q));
+    }
+#endif
+}
+
+TEST_CASE("Sign of packed permutations", "[perm16]") {
+    std::vector<int> seq = {0, 1, 2, 3, 4, 5};
+    Perm16 p(seq);
+    do {
+        REQUIRE(sgn(p) == sgn(seq.begin(), seq.end()));
+        next_permutation(p);
+    } while (next_permutation(seq));
+
+    std::mt19937 gen(42);
+    auto seq16 = random_permutation(16, gen);
+    REQUIRE(sgn(Perm16(seq16)) == sgn(seq16.begin(), seq16.end()));
+}
+
+TEST_CASE("Packed next_permutation agrees with vector version",
+    "[perm16]")
+{
+    for (int n = 0; n < 8; ++n) {
+        Perm16 p(n);
+        auto seq = p.to_vector();
+        bool more = true;
+        while (more) {
+            more = next_permutation(seq);
+            REQUIRE(next_permutation(p) == more);
+            REQUIRE(p.to_vector() == seq);
+        }
+    }
+}
+
+TEST_CASE("Packed johnson_trotter agrees with vector version",
+    "[perm16]")
+{
+    for (int n = 0; n < 8; ++n) {
+        Perm16 p(n);
+        auto seq = p.to_vector();
+        bool more = true;
+        while (more) {
+            more = johnson_trotter(seq);
+            REQUIRE(johnson_trotter(p) == more);
+            REQUIRE(p.to_vector() == seq);
+        }
+    }
+}
+
+TEST_CASE("Emit blocks of packed permutations", "[perm16]") {
+    const int n = 7;
+    const size_t total = 5040;
+    const size_t block = 1000;
+
+    for (auto step : {next_permutation_block, johnson_trotter_block}) {
+        std::vector<uint64_t> out(1, Perm16(n).word());
+        Perm16 p(n);
+        size_t k = block;
+        while (k == block) {
+            out.resize(out.size() + block);
+            k = step(p, out.data() + out.size() - block, block);
+            out.resize(out.size() - block + k);
+        }
+        REQUIRE(out.size() == total);
+        REQUIRE(p.word() == out.back());
+
+        std::sort(out.begin(), out.end());
+        REQUIRE(std::unique(out.begin(), out.end()) == out.end());
+    }
+}
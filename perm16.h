@@ -0,0 +1,256 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <assert.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define PERM16_SSSE3_ENABLED 1
+#include <tmmintrin.h>
+#define SSSE3_TARGET __attribute__((target("ssse3")))
+#else
+#define PERM16_SSSE3_ENABLED 0
+#endif
+
+//
+// Permutation of {0, ..., n - 1} for n <= 16 packed into a single 64-bit
+// word: the image of i is the 4-bit nibble at bits [4i, 4i + 4).
+//
+// Nibbles at positions >= n always hold the identity, so compose and
+// inverse work on all 16 nibbles at once and never have to look at n.
+//
+class Perm16 {
+public:
+    static constexpr int MAX_SIZE = 16;
+    static constexpr uint64_t IDENTITY = 0xFEDCBA9876543210ULL;
+
+    // identity of size n
+    explicit Perm16(int n = 0) : word_(IDENTITY), n_(n) {
+        assert(0 <= n && n <= MAX_SIZE);
+    }
+
+    // packed word, nibbles at positions >= n have to be the identity
+    Perm16(uint64_t word, int n) : word_(word), n_(n) {
+        assert(0 <= n && n <= MAX_SIZE);
+    }
+
+    // assumption: seq == {0, ..., n - 1} as set
+    explicit Perm16(const std::vector<int>& seq)
+        : word_(IDENTITY), n_(static_cast<int>(seq.size()))
+    {
+        assert(seq.size() <= MAX_SIZE);
+        for (int i = 0; i < n_; ++i) {
+            set(i, seq[i]);
+        }
+    }
+
+    int size() const { return n_; }
+    uint64_t word() const { return word_; }
+
+    int operator[](int i) const { return (word_ >> (4 * i)) & 0xF; }
+
+    // swap images at positions i and j
+    void swap(int i, int j) {
+        const uint64_t x = ((word_ >> (4 * i)) ^ (word_ >> (4 * j))) & 0xF;
+        word_ ^= (x << (4 * i)) | (x << (4 * j));
+    }
+
+    std::vector<int> to_vector() const {
+        std::vector<int> seq(n_);
+        for (int i = 0; i < n_; ++i) {
+            seq[i] = (*this)[i];
+        }
+        return seq;
+    }
+
+    bool operator==(const Perm16& p) const {
+        return word_ == p.word_ && n_ == p.n_;
+    }
+    bool operator!=(const Perm16& p) const { return !(*this == p); }
+
+private:
+    void set(int i, int v) {
+        word_ &= ~(uint64_t(0xF) << (4 * i));
+        word_ |= uint64_t(v) << (4 * i);
+    }
+
+    uint64_t word_;
+    int n_;
+};
+
+
+// (p ∘ q)[i] = p[q[i]], i.e. first apply q, then p, one nibble at a time
+inline Perm16 compose_nibbles(const Perm16& p, const Perm16& q) {
+    assert(p.size() == q.size());
+    uint64_t word = 0;
+    for (int i = 0; i < Perm16::MAX_SIZE; ++i) {
+        word |= uint64_t(p[q[i]]) << (4 * i);
+    }
+    return Perm16(word, p.size());
+}
+
+inline bool ssse3_supported() {
+#if PERM16_SSSE3_ENABLED
+    static const bool supported = __builtin_cpu_supports("ssse3");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+#if PERM16_SSSE3_ENABLED
+// 16 nibbles -> 16 bytes
+SSSE3_TARGET inline __m128i perm16_unpack(uint64_t word) {
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i v = _mm_cvtsi64_si128(word);
+    const __m128i lo = _mm_and_si128(v, mask);
+    const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+    return _mm_unpacklo_epi8(lo, hi);
+}
+
+// 16 bytes -> 16 nibbles
+SSSE3_TARGET inline uint64_t perm16_pack(__m128i bytes) {
+    // b[2k] + 16 * b[2k + 1] in every 16-bit lane
+    const __m128i pairs = _mm_maddubs_epi16(bytes, _mm_set1_epi16(0x1001));
+    return _mm_cvtsi128_si64(_mm_packus_epi16(pairs, pairs));
+}
+
+// all 16 lookups p[q[i]] by one pshufb; callers check ssse3_supported()
+SSSE3_TARGET inline Perm16 compose_ssse3(const Perm16& p, const Perm16& q) {
+    assert(p.size() == q.size());
+    const __m128i r = _mm_shuffle_epi8(
+        perm16_unpack(p.word()), perm16_unpack(q.word()));
+    return Perm16(perm16_pack(r), p.size());
+}
+#endif
+
+
+// (p ∘ q)[i] = p[q[i]], i.e. first apply q, then p
+inline Perm16 compose(const Perm16& p, const Perm16& q) {
+#if PERM16_SSSE3_ENABLED
+    if (ssse3_supported()) {
+        return compose_ssse3(p, q);
+    }
+#endif
+    return compose_nibbles(p, q);
+}
+
+inline Perm16 inverse(const Perm16& p) {
+    // every nibble is written exactly once, since p is a bijection on all
+    // 16 positions
+    uint64_t word = 0;
+    for (int i = 0; i < Perm16::MAX_SIZE; ++i) {
+        word |= uint64_t(i) << (4 * p[i]);
+    }
+    return Perm16(word, p.size());
+}
+
+// parity of the number of inversions; values seen so far are kept in a
+// bitmask, so each step is a single popcount
+inline int sgn(const Perm16& p) {
+    unsigned seen = 0;
+    unsigned parity = 0;
+    for (int i = 0; i < p.size(); ++i) {
+        const int v = p[i];
+        parity ^= __builtin_popcount(seen >> v) & 1;
+        seen |= 1u << v;
+    }
+    return parity == 0 ? 1 : -1;
+}
+
+// lexicographic successor, same order as next_permutation(std::vector<T>&)
+inline bool next_permutation(Perm16& p) {
+    const int n = p.size();
+    if (n < 2) {
+        return false;
+    }
+
+    // find pivot
+    int i = n - 1;
+    while (i > 0 && p[i - 1] >= p[i]) {
+        i--;
+    }
+
+    // last permutation
+    if (i == 0) {
+        return false;
+    }
+
+    // find right most element greater than pivot
+    int j = n - 1;
+    while (p[j] <= p[i - 1]) {
+        j--;
+    }
+    p.swap(i - 1, j);
+
+    // reverse suffix
+    for (j = n - 1; i < j; ++i, --j) {
+        p.swap(i, j);
+    }
+    return true;
+}
+
+// plain-changes successor, same order as johnson_trotter(std::vector<int>&)
+//
+// The naive version computes the sign of every prefix of the inverse
+// permutation separately. Here the positions of all values < i are kept in
+// a bitmask, which gives the parity of the prefix incrementally and also
+// tells whether the neighbour in direction of i is smaller than i.
+inline bool johnson_trotter(Perm16& p) {
+    const int n = p.size();
+    const Perm16 inv = inverse(p);
+
+    unsigned smaller = 0;  // positions of values < i
+    unsigned parity = 0;   // parity of inversions of inv[0, i)
+    int mobile = -1;
+    int target = 0;
+    for (int i = 0; i < n; ++i) {
+        const int pos = inv[i];
+        const int y = parity == 0 ? pos - 1 : pos + 1;
+        if (0 <= y && y < n && (smaller >> y & 1)) {
+            mobile = i;
+            target = y;
+        }
+        parity ^= __builtin_popcount(smaller >> pos) & 1;
+        smaller |= 1u << pos;
+    }
+
+    // last permutation
+    if (mobile < 0) {
+        return false;
+    }
+
+    p.swap(inv[mobile], target);
+    return true;
+}
+
+
+//
+// Bulk API
+//
+// Writes up to count successors of p as packed words into out and advances
+// p to the last one written. Returns the number of written permutations;
+// less than count means that p reached the last permutation.
+//
+
+template<typename Step>
+size_t generate_block(Perm16& p, uint64_t* out, size_t count, Step step) {
+    size_t k = 0;
+    while (k < count && step(p)) {
+        out[k++] = p.word();
+    }
+    return k;
+}
+
+inline size_t next_permutation_block(Perm16& p, uint64_t* out, size_t count)
+{
+    return generate_block(p, out, count,
+        [](Perm16& q) { return next_permutation(q); });
+}
+
+inline size_t johnson_trotter_block(Perm16& p, uint64_t* out, size_t count)
+{
+    return generate_block(p, out, count,
+        [](Perm16& q) { return johnson_trotter(q); });
+}
@@ -0,0 +1,228 @@
+//
+// Throughput of the permutation generators
+//
+
+#include "next_permutation.h"
+#include "johnson_trotter.h"
+#include "permutation_range.h"
+#include "perm16.h"
+
+#include <catch.hpp>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <functional>
+
+
+uint64_t factorial(int n) {
+    uint64_t res = 1;
+    for (int i = 2; i <= n; ++i) {
+        res *= i;
+    }
+    return res;
+}
+
+std::vector<int> identity(int n) {
+    std::vector<int> seq(n);
+    for (int i = 0; i < n; ++i) {
+        seq[i] = i;
+    }
+    return seq;
+}
+
+// index of seq in lexicographic order (Lehmer code)
+uint64_t lexicographic_rank(const std::vector<int>& seq) {
+    const int n = seq.size();
+    uint64_t rank = 0;
+    unsigned seen = 0;
+    for (int i = 0; i < n; ++i) {
+        const int smaller = seq[i] - __builtin_popcount(seen & ((1u << seq[i]) - 1));
+        rank = rank * (n - i) + smaller;
+        seen |= 1u << seq[i];
+    }
+    return rank;
+}
+
+
+// Generators under test: each one is a factory returning a step function
+// which advances a permutation of {0, ..., n - 1} in place.
+using Step = std::function<bool(std::vector<int>&)>;
+
+struct Generator {
+    std::string name;
+    std::function<Step()> make;
+};
+
+std::vector<Generator> generators() {
+    return {
+        {"next_permutation", []() -> Step {
+            return [](std::vector<int>& seq) { return next_permutation(seq); };
+        }},
+        {"johnson_trotter", []() -> Step {
+            return [](std::vector<int>& seq) { return johnson_trotter(seq); };
+        }},
+        {"johnson_trotter_improved", []() -> Step {
+            return [](std::vector<int>& seq) {
+                return johnson_trotter_improved(seq);
+            };
+        }},
+        {"plain changes (Algorithm P)", []() -> Step {
+            return PlainChangeStep();
+        }},
+        {"heap", []() -> Step {
+            return HeapStep();
+        }},
+        {"perm16 next_permutation", []() -> Step {
+            return [](std::vector<int>& seq) {
+                Perm16 p(seq);
+                bool res = next_permutation(p);
+                seq = p.to_vector();
+                return res;
+            };
+        }},
+    };
+}
+
+
+TEST_CASE("Every generator visits exactly n! distinct permutations",
+    "[permutation_benchmark]")
+{
+    for (const auto& generator : generators()) {
+        INFO(generator.name);
+        for (int n = 1; n < 9; ++n) {
+            std::vector<bool> visited(factorial(n), false);
+            auto seq = identity(n);
+            auto step = generator.make();
+
+            uint64_t count = 0;
+            do {
+                auto rank = lexicographic_rank(seq);
+                REQUIRE(!visited[rank]);
+                visited[rank] = true;
+                count += 1;
+            } while (step(seq));
+            REQUIRE(count == factorial(n));
+        }
+    }
+}
+
+
+// Runs step until the last permutation or until limit permutations were
+// visited. Returns permutations per second.
+template<typename Step, typename Consumer>
+double throughput(int n, uint64_t limit, Step step, Consumer consume) {
+    auto seq = identity(n);
+    uint64_t count = 1;
+
+    auto start = std::chrono::steady_clock::now();
+    consume(seq);
+    while (count < limit && step(seq)) {
+        consume(seq);
+        count += 1;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double> elapsed = end - start;
+    return count / elapsed.count();
+}
+
+template<typename Step>
+void benchmark(const std::string& name, Step make_step, uint64_t limit) {
+    volatile int64_t sink = 0;
+    for (int n = 8; n <= 13; ++n) {
+        const double bare = throughput(n, limit, make_step(),
+            [](const std::vector<int>&) {});
+
+        int64_t checksum = 0;
+        const double consumed = throughput(n, limit, make_step(),
+            [&checksum](const std::vector<int>& seq) {
+                for (size_t i = 0; i < seq.size(); ++i) {
+                    checksum += seq[i] * (i + 1);
+                }
+            });
+        sink = sink + checksum;
+
+        std::cout << std::setw(30) << std::left << name
+            << " n = " << std::setw(2) << n
+            << std::right << std::fixed << std::setprecision(1)
+            << std::setw(10) << bare / 1e6 << " M/s"
+            << std::setw(10) << consumed / 1e6 << " M/s (consumer)"
+            << std::endl;
+    }
+}
+
+
+// Hidden, since it takes a while. Run with
+//
+//   ./permutation_benchmark [benchmark]
+//
+// Each generator runs for at most 10^7 permutations per n (the naive
+// johnson_trotter calls the quadratic sgn on every prefix, so it is O(n^3)
+// per step and gets 10^5).
+TEST_CASE("Permutation generator throughput", "[.][benchmark]") {
+    benchmark("next_permutation", []() {
+        return [](std::vector<int>& seq) { return next_permutation(seq); };
+    }, 10000000);
+    benchmark("std::next_permutation", []() {
+        return [](std::vector<int>& seq) {
+            return std::next_permutation(seq.begin(), seq.end());
+        };
+    }, 10000000);
+    benchmark("johnson_trotter", []() {
+        return [](std::vector<int>& seq) { return johnson_trotter(seq); };
+    }, 100000);
+    benchmark("johnson_trotter_improved", []() {
+        return [](std::vector<int>& seq) {
+            return johnson_trotter_improved(seq);
+        };
+    }, 1000000);
+    benchmark("plain changes (Algorithm P)", []() {
+        return PlainChangeStep();
+    }, 10000000);
+    benchmark("heap", []() { return HeapStep(); }, 10000000);
+
+    // packed permutations without conversion to std::vector; the bare run
+    // only writes the buffer
+    for (int n = 8; n <= 13; ++n) {
+        for (auto step : {next_permutation_block, johnson_trotter_block}) {
+            auto block_throughput = [n, step](bool consume, uint64_t& checksum) {
+                const size_t block = 1024;
+                std::vector<uint64_t> out(block);
+                Perm16 p(n);
+                uint64_t count = 0;
+
+                auto start = std::chrono::steady_clock::now();
+                size_t k = block;
+                while (k == block && count < 10000000) {
+                    k = step(p, out.data(), block);
+                    if (consume) {
+                        for (size_t i = 0; i < k; ++i) {
+                            checksum ^= out[i];
+                        }
+                    }
+                    count += k;
+                }
+                auto end = std::chrono::steady_clock::now();
+                std::chrono::duration<double> elapsed = end - start;
+                return count / elapsed.count();
+            };
+
+            uint64_t checksum = 0;
+            const double bare = block_throughput(false, checksum);
+            const double consumed = block_throughput(true, checksum);
+
+            std::cout << std::setw(30) << std::left
+                << (step == next_permutation_block
+                    ? "perm16 next_permutation_block"
+                    : "perm16 johnson_trotter_block")
+                << " n = " << std::setw(2) << n
+                << std::right << std::fixed << std::setprecision(1)
+                << std::setw(10) << bare / 1e6 << " M/s"
+                << std::setw(10) << consumed / 1e6 << " M/s (consumer)"
+                << std::endl;
+            REQUIRE(checksum != 0);
+        }
+    }
+}
@@ -0,0 +1,141 @@
+#include "permutation_range.h"
+#include "next_permutation.h"
+#include "johnson_trotter.h"
+
+#include <catch.hpp>
+#include <vector>
+#include <string>
+#include <set>
+#include <algorithm>
+#include <iterator>
+
+
+TEST_CASE("Range of lexicographic permutations", "[permutation_range]") {
+    std::vector<int> seq = {0, 1, 2, 3, 4, 5};
+
+    for (size_t block_size : {1, 7, 720, 1000}) {
+        auto expected = seq;
+        auto range = lexicographic_permutations(seq, block_size);
+        auto it = range.begin();
+        bool more = true;
+        while (more) {
+            REQUIRE(it != range.end());
+            REQUIRE(*it == expected);
+            ++it;
+            more = next_permutation(expected);
+        }
+        REQUIRE(it == range.end());
+    }
+}
+
+TEST_CASE("Range of plain changes", "[permutation_range]") {
+    for (int n = 0; n < 7; ++n) {
+        std::vector<int> seq(n);
+        for (int i = 0; i < n; ++i) {
+            seq[i] = i;
+        }
+
+        auto expected = seq;
+        auto range = plain_change_permutations(seq, 16);
+        auto it = range.begin();
+        bool more = true;
+        while (more) {
+            REQUIRE(it != range.end());
+            REQUIRE(*it == expected);
+            ++it;
+            more = johnson_trotter(expected);
+        }
+        REQUIRE(it == range.end());
+    }
+}
+
+TEST_CASE("Range of multiset permutations", "[permutation_range]") {
+    auto range = multiset_permutations(std::vector<int>{2, 1, 1, 0});
+    REQUIRE(std::distance(range.begin(), range.end()) == 12);
+
+    auto words = multiset_permutations(std::vector<char>{'b', 'a', 'a'});
+    std::vector<std::string> result;
+    std::transform(words.begin(), words.end(), std::back_inserter(result),
+        [](const PermutationView<char>& p) {
+            return std::string(p.begin(), p.end());
+        });
+    REQUIRE(result == (std::vector<std::string>{"aab", "aba", "baa"}));
+}
+
+TEST_CASE("Use permutation ranges with standard algorithms",
+    "[permutation_range]")
+{
+    std::vector<std::string> names = {"a", "b", "c", "d", "e", "f", "g"};
+
+    auto all = plain_change_permutations(names);
+    REQUIRE(std::distance(all.begin(), all.end()) == 5040);
+
+    // permutations fixing the first element
+    auto range = lexicographic_permutations(names);
+    auto fixed = std::count_if(range.begin(), range.end(),
+        [](const PermutationView<std::string>& p) { return p[0] == "a"; });
+    REQUIRE(fixed == 720);
+
+    auto lex = lexicographic_permutations(names);
+    auto it = std::find_if(lex.begin(), lex.end(),
+        [](const PermutationView<std::string>& p) { return p[0] == "b"; });
+    REQUIRE(it != lex.end());
+    REQUIRE((*it).to_vector() ==
+        (std::vector<std::string>{"b", "a", "c", "d", "e", "f", "g"}));
+}
+
+// written against the input iterator requirements only
+template<typename InputIt, typename OutputIt>
+OutputIt copy_as_vectors(InputIt first, InputIt last, OutputIt out) {
+    while (first != last) {
+        *out++ = (*first++).to_vector();
+    }
+    return out;
+}
+
+TEST_CASE("Permutation range iterators are input iterators",
+    "[permutation_range]")
+{
+    // block size 1 refills the buffer on every increment
+    for (size_t block_size : {1, 2, 256}) {
+        auto range = lexicographic_permutations(std::vector<int>{0, 1, 2},
+            block_size);
+        std::vector<std::vector<int>> result;
+        copy_as_vectors(range.begin(), range.end(), std::back_inserter(result));
+        REQUIRE(result == (std::vector<std::vector<int>>{
+            {0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}}));
+    }
+
+    auto range = plain_change_permutations(std::vector<int>{0, 1, 2}, 1);
+    auto it = range.begin();
+    REQUIRE(it->size() == 3);
+    REQUIRE((*it)[2] == 2);
+    REQUIRE(*it++ == (std::vector<int>{0, 1, 2}));
+    REQUIRE(*it == (std::vector<int>{0, 2, 1}));
+}
+
+TEST_CASE("Range of Heap's algorithm permutations", "[permutation_range]") {
+    auto range = heap_permutations(std::vector<int>{0, 1, 2});
+    std::vector<std::vector<int>> result;
+    for (auto p : range) {
+        result.push_back(p.to_vector());
+    }
+    REQUIRE(result == (std::vector<std::vector<int>>{
+        {0, 1, 2}, {1, 0, 2}, {2, 0, 1}, {0, 2, 1}, {1, 2, 0}, {2, 1, 0}}));
+
+    for (int n = 0; n < 8; ++n) {
+        std::vector<int> seq(n);
+        for (int i = 0; i < n; ++i) {
+            seq[i] = i;
+        }
+        std::set<std::vector<int>> visited;
+        for (auto p : heap_permutations(seq)) {
+            visited.insert(p.to_vector());
+        }
+        size_t factorial = 1;
+        for (int i = 2; i <= n; ++i) {
+            factorial *= i;
+        }
+        REQUIRE(visited.size() == factorial);
+    }
+}
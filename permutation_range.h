@@ -0,0 +1,307 @@
+#pragma once
+
+#include "next_permutation.h"
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <assert.h>
+
+//
+// Lazy ranges of permutations
+//
+// The generators mutate a vector one step at a time. PermutationRange wraps
+// such a step into an input range, so that it can be consumed by standard
+// algorithms. Permutations are generated in blocks into a contiguous buffer
+// which is reused for the next block, i.e. incrementing an iterator is just
+// a pointer bump most of the time.
+//
+
+// non-owning view of a single permutation inside the block buffer
+template<typename T>
+class PermutationView {
+public:
+    PermutationView(const T* begin, const T* end) : begin_(begin), end_(end) {}
+
+    const T* begin() const { return begin_; }
+    const T* end() const { return end_; }
+    size_t size() const { return end_ - begin_; }
+    const T& operator[](size_t i) const { return begin_[i]; }
+
+    std::vector<T> to_vector() const { return std::vector<T>(begin_, end_); }
+
+    bool operator==(const std::vector<T>& seq) const {
+        return size() == seq.size() && std::equal(begin_, end_, seq.begin());
+    }
+    bool operator!=(const std::vector<T>& seq) const { return !(*this == seq); }
+
+private:
+    const T* begin_;
+    const T* end_;
+};
+
+
+template<typename T, typename Step>
+class PermutationRange {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 256;
+
+    class iterator {
+    public:
+        // views are returned by value, so it->size() needs a holder
+        class arrow_proxy {
+        public:
+            explicit arrow_proxy(PermutationView<T> view) : view_(view) {}
+            const PermutationView<T>* operator->() const { return &view_; }
+
+        private:
+            PermutationView<T> view_;
+        };
+
+        // the buffer may be refilled by the increment, so *it++ has to
+        // keep a copy of the permutation it points to
+        class postfix_proxy {
+        public:
+            explicit postfix_proxy(PermutationView<T> view)
+                : seq_(view.to_vector()) {}
+            PermutationView<T> operator*() const {
+                return PermutationView<T>(seq_.data(), seq_.data() + seq_.size());
+            }
+
+        private:
+            std::vector<T> seq_;
+        };
+
+        using iterator_category = std::input_iterator_tag;
+        using value_type = PermutationView<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = arrow_proxy;
+        using reference = PermutationView<T>;
+
+        iterator() : range_(nullptr) {}
+        explicit iterator(PermutationRange* range) : range_(range) {}
+
+        PermutationView<T> operator*() const { return range_->current(); }
+        arrow_proxy operator->() const { return arrow_proxy(**this); }
+
+        iterator& operator++() {
+            range_->advance();
+            return *this;
+        }
+        postfix_proxy operator++(int) {
+            postfix_proxy res(**this);
+            ++*this;
+            return res;
+        }
+
+        bool operator==(const iterator& it) const {
+            return at_end() == it.at_end();
+        }
+        bool operator!=(const iterator& it) const { return !(*this == it); }
+
+    private:
+        bool at_end() const { return range_ == nullptr || range_->empty(); }
+
+        PermutationRange* range_;
+    };
+
+    // first permutation is seq itself
+    PermutationRange(std::vector<T> seq, Step step,
+            size_t block_size = DEFAULT_BLOCK_SIZE)
+        : seq_(std::move(seq))
+        , step_(std::move(step))
+        , block_size_(block_size)
+        , buffer_(block_size * seq_.size())
+    {
+        assert(block_size > 0);
+        refill();
+    }
+
+    // single pass: begin() continues where the last iterator stopped
+    iterator begin() { return iterator(this); }
+    iterator end() { return iterator(); }
+
+    bool empty() const { return pos_ == size_; }
+
+private:
+    PermutationView<T> current() const {
+        assert(!empty());
+        const T* p = buffer_.data() + pos_ * seq_.size();
+        return PermutationView<T>(p, p + seq_.size());
+    }
+
+    void advance() {
+        assert(!empty());
+        pos_ += 1;
+        if (pos_ == size_ && !exhausted_) {
+            refill();
+        }
+    }
+
+    void refill() {
+        const size_t n = seq_.size();
+        pos_ = 0;
+        size_ = 0;
+        while (size_ < block_size_ && !exhausted_) {
+            std::copy(seq_.begin(), seq_.end(), buffer_.begin() + size_ * n);
+            size_ += 1;
+            exhausted_ = !step_(seq_);
+        }
+    }
+
+    std::vector<T> seq_;  // next permutation not yet in the buffer
+    Step step_;
+    size_t block_size_;
+    std::vector<T> buffer_;
+    size_t size_ = 0;  // number of permutations in buffer
+    size_t pos_ = 0;   // current permutation in buffer
+    bool exhausted_ = false;
+};
+
+
+//
+// Steps
+//
+
+// lexicographic order, works also for multisets
+struct LexicographicStep {
+    template<typename T>
+    bool operator()(std::vector<T>& seq) const {
+        return next_permutation(seq);
+    }
+};
+
+// plain changes (Johnson-Trotter order) of arbitrary elements
+//
+// Stateful version of Knuth's Algorithm P (TAOCP 7.2.1.2): instead of
+// recomputing inversions in every step like johnson_trotter_improved, the
+// inversion counts c and directions o are kept between steps, which makes
+// a step O(1) amortized.
+class PlainChangeStep {
+public:
+    template<typename T>
+    bool operator()(std::vector<T>& seq) {
+        const int n = static_cast<int>(seq.size());
+        if (c_.empty()) {
+            c_.assign(n + 1, 0);
+            o_.assign(n + 1, 1);
+        }
+
+        // 1-based as in Knuth's description
+        int j = n;
+        int s = 0;
+        while (j > 0) {
+            const int q = c_[j] + o_[j];
+            if (q < 0) {
+                o_[j] = -o_[j];
+                j -= 1;
+            } else if (q == j) {
+                if (j == 1) {
+                    return false;
+                }
+                s += 1;
+                o_[j] = -o_[j];
+                j -= 1;
+            } else {
+                const int a = j - c_[j] + s - 1;
+                const int b = j - q + s - 1;
+                std::swap(seq[a], seq[b]);
+                position_ = std::min(a, b);
+                c_[j] = q;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // the last step swapped seq[position()] and seq[position() + 1]
+    int position() const { return position_; }
+
+private:
+    std::vector<int> c_;  // inversion counts
+    std::vector<int> o_;  // directions
+    int position_ = -1;
+};
+
+// Heap's algorithm, iterative version
+//
+// Every step is a single (not necessarily adjacent) transposition and only
+// touches the first i + 1 elements; most steps have i < 3.
+class HeapStep {
+public:
+    template<typename T>
+    bool operator()(std::vector<T>& seq) {
+        const int n = static_cast<int>(seq.size());
+        if (c_.size() != seq.size()) {
+            c_.assign(n, 0);
+            i_ = 1;
+        }
+
+        while (i_ < n) {
+            if (c_[i_] < i_) {
+                if (i_ % 2 == 0) {
+                    std::swap(seq[0], seq[i_]);
+                } else {
+                    std::swap(seq[c_[i_]], seq[i_]);
+                }
+                c_[i_] += 1;
+                i_ = 1;
+                return true;
+            }
+            c_[i_] = 0;
+            i_ += 1;
+        }
+        return false;
+    }
+
+private:
+    std::vector<int> c_;  // loop counters of the recursive version
+    int i_ = 1;
+};
+
+
+//
+// Factories
+//
+
+// permutations following seq in lexicographic order (including seq)
+template<typename T>
+PermutationRange<T, LexicographicStep> lexicographic_permutations(
+    std::vector<T> seq,
+    size_t block_size = PermutationRange<T, LexicographicStep>::DEFAULT_BLOCK_SIZE)
+{
+    return PermutationRange<T, LexicographicStep>(
+        std::move(seq), LexicographicStep(), block_size);
+}
+
+// all distinct permutations of the multiset seq
+template<typename T>
+PermutationRange<T, LexicographicStep> multiset_permutations(
+    std::vector<T> seq,
+    size_t block_size = PermutationRange<T, LexicographicStep>::DEFAULT_BLOCK_SIZE)
+{
+    std::sort(seq.begin(), seq.end());
+    return lexicographic_permutations(std::move(seq), block_size);
+}
+
+// all permutations of seq in plain-change order starting with seq
+template<typename T>
+PermutationRange<T, PlainChangeStep> plain_change_permutations(
+    std::vector<T> seq,
+    size_t block_size = PermutationRange<T, PlainChangeStep>::DEFAULT_BLOCK_SIZE)
+{
+    return PermutationRange<T, PlainChangeStep>(
+        std::move(seq), PlainChangeStep(), block_size);
+}
+
+// all permutations of seq in the order of Heap's algorithm
+template<typename T>
+PermutationRange<T, HeapStep> heap_permutations(
+    std::vector<T> seq,
+    size_t block_size = PermutationRange<T, HeapStep>::DEFAULT_BLOCK_SIZE)
+{
+    return PermutationRange<T, HeapStep>(
+        std::move(seq), HeapStep(), block_size);
+}
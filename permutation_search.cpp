@@ -0,0 +1,115 @@
+#include "permutation_search.h"
+#include "next_permutation.h"
+
+#include <catch.hpp>
+#include <vector>
+#include <random>
+
+
+template<typename T>
+std::vector<std::vector<T>> random_matrix(int n, std::mt19937& gen) {
+    std::uniform_int_distribution<T> dis(1, 100);
+    std::vector<std::vector<T>> m(n, std::vector<T>(n));
+    for (auto& row : m) {
+        for (auto& x : row) {
+            x = dis(gen);
+        }
+    }
+    return m;
+}
+
+// recompute the full cost of every permutation
+template<typename Problem>
+typename Problem::Cost brute_force(const Problem& problem) {
+    const int n = problem.size();
+    std::vector<int> perm(n);
+    for (int i = 0; i < n; ++i) {
+        perm[i] = i;
+    }
+
+    auto best = std::numeric_limits<typename Problem::Cost>::max();
+    do {
+        typename Problem::Cost cost = 0;
+        for (int k = 0; k < n; ++k) {
+            cost += problem.step(k, k > 0 ? perm[k - 1] : -1, perm[k]);
+        }
+        if (n > 0) {
+            cost += problem.finish(perm.front(), perm.back());
+        }
+        best = std::min(best, cost);
+    } while (next_permutation(perm));
+    return best;
+}
+
+template<typename Problem>
+typename Problem::Cost cost_of(const Problem& problem,
+    const std::vector<int>& perm)
+{
+    typename Problem::Cost cost = 0;
+    for (int k = 0; k < problem.size(); ++k) {
+        cost += problem.step(k, k > 0 ? perm[k - 1] : -1, perm[k]);
+    }
+    if (!perm.empty()) {
+        cost += problem.finish(perm.front(), perm.back());
+    }
+    return cost;
+}
+
+
+TEST_CASE("Trivial assignment problems", "[permutation_search]") {
+    using Matrix = std::vector<std::vector<int>>;
+
+    AssignmentProblem<int> empty(Matrix{});
+    REQUIRE(branch_and_bound(empty).cost == 0);
+    REQUIRE(plain_change_search(empty).cost == 0);
+
+    AssignmentProblem<int> single(Matrix{{7}});
+    REQUIRE(branch_and_bound(single).cost == 7);
+    REQUIRE(plain_change_search(single).perm == (std::vector<int>{0}));
+
+    AssignmentProblem<int> two(Matrix{{1, 5}, {2, 9}});
+    REQUIRE(branch_and_bound(two).perm == (std::vector<int>{1, 0}));
+    REQUIRE(plain_change_search(two).cost == 7);
+}
+
+TEST_CASE("Solve assignment problems", "[permutation_search]") {
+    std::mt19937 gen(42);
+    for (int n = 3; n < 9; ++n) {
+        AssignmentProblem<int> problem(random_matrix<int>(n, gen));
+        auto expected = brute_force(problem);
+
+        for (int threads : {1, 4}) {
+            // 0: bounds down to the leaves, n: walks below every prefix
+            for (int walk_size : {0, 1, 4, n}) {
+                auto result = branch_and_bound(problem, threads, walk_size);
+                REQUIRE(result.cost == expected);
+                REQUIRE(cost_of(problem, result.perm) == expected);
+            }
+        }
+
+        auto result = plain_change_search(problem);
+        REQUIRE(result.cost == expected);
+        REQUIRE(cost_of(problem, result.perm) == expected);
+    }
+}
+
+TEST_CASE("Solve travelling salesman problems", "[permutation_search]") {
+    std::mt19937 gen(42);
+    for (int n = 3; n < 9; ++n) {
+        TravellingSalesmanProblem<int64_t> problem(random_matrix<int64_t>(n, gen));
+        auto expected = brute_force(problem);
+
+        for (int threads : {1, 4}) {
+            // 0: bounds down to the leaves, n: walks below every prefix
+            for (int walk_size : {0, 1, 4, n}) {
+                auto result = branch_and_bound(problem, threads, walk_size);
+                REQUIRE(result.cost == expected);
+                REQUIRE(cost_of(problem, result.perm) == expected);
+            }
+        }
+
+        auto result = plain_change_search(problem);
+        REQUIRE(result.cost == expected);
+        REQUIRE(cost_of(problem, result.perm) == expected);
+    }
+}
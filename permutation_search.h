@@ -0,0 +1,326 @@
+#pragma once
+
+#include "permutation_range.h"
+
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+#include <assert.h>
+
+//
+// Search for a permutation of minimal cost
+//
+// Instead of computing the cost of every permutation from scratch, the
+// permutations are walked as a prefix tree: appending an element to a prefix
+// changes the cost by a single term, and subtrees whose lower bound is not
+// better than the best permutation found so far are pruned. Near the leaves
+// a bound costs more than it prunes, so the last few positions of a
+// surviving prefix are walked in plain-change order instead, where every
+// step is an adjacent transposition and updates the cost by swap_delta.
+//
+// A Problem provides
+//
+//   using Cost = ...;
+//   int size() const;
+//   // cost of placing v at position k after u (u = -1 if k = 0)
+//   Cost step(int k, int u, int v) const;
+//   // cost of closing a complete permutation
+//   Cost finish(int first, int last) const;
+//   // lower bound of filling positions k, ..., n - 1 with unused elements
+//   Cost bound(int k, const std::vector<bool>& used) const;
+//   // cost change when perm[i] and perm[i + 1] are swapped
+//   Cost swap_delta(const std::vector<int>& perm, int i) const;
+//
+
+template<typename Cost>
+struct SearchResult {
+    Cost cost;
+    std::vector<int> perm;
+};
+
+
+// Calls visit(cost, perm) for all orders of perm[k], ..., perm[n - 1] in
+// plain-change order, where cost is the cost of the complete permutation
+// perm on entry. Every step is an adjacent transposition, so the cost is
+// updated by swap_delta in O(1) instead of being recomputed in O(n).
+template<typename Problem, typename Visit>
+void plain_change_walk(const Problem& problem, std::vector<int>& perm, int k,
+    typename Problem::Cost cost, Visit visit)
+{
+    visit(cost, perm);
+    std::vector<int> tail(perm.begin() + k, perm.end());
+    PlainChangeStep step;
+    while (step(tail)) {
+        const int i = k + step.position();
+        std::swap(perm[i], perm[i + 1]);
+        // swapping back would change the cost by swap_delta
+        cost -= problem.swap_delta(perm, i);
+        visit(cost, perm);
+    }
+}
+
+
+template<typename Problem>
+class BranchAndBound {
+public:
+    using Cost = typename Problem::Cost;
+
+    static constexpr int DEFAULT_WALK_SIZE = 4;
+
+    // the last walk_size positions are walked without bounds
+    BranchAndBound(const Problem& problem, int walk_size = DEFAULT_WALK_SIZE)
+        : problem_(problem)
+        , n_(problem.size())
+        , walk_size_(walk_size)
+        , best_cost_(std::numeric_limits<Cost>::max())
+    {
+        assert(walk_size >= 0);
+    }
+
+    // Subtrees below the prefixes of length 2 are distributed over the
+    // threads. The cost of the best permutation is shared, so a good
+    // permutation found by one thread prunes the search of all others.
+    SearchResult<Cost> operator()(int num_threads = 1) {
+        assert(num_threads > 0);
+        if (n_ < 2) {
+            std::vector<int> perm(n_, 0);
+            Cost cost = n_ == 0
+                ? Cost(0)
+                : problem_.step(0, -1, 0) + problem_.finish(0, 0);
+            return {cost, perm};
+        }
+
+        std::atomic<int> next_task(0);
+        auto worker = [this, &next_task]() {
+            std::vector<int> prefix;
+            std::vector<bool> used(n_, false);
+            prefix.reserve(n_);
+
+            int task;
+            while ((task = next_task++) < n_ * n_) {
+                const int a = task / n_;
+                const int b = task % n_;
+                if (a == b) {
+                    continue;
+                }
+
+                prefix.assign({a, b});
+                used[a] = used[b] = true;
+                search(prefix, used,
+                    problem_.step(0, -1, a) + problem_.step(1, a, b));
+                used[a] = used[b] = false;
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (int i = 1; i < num_threads; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        return {best_cost_.load(), best_perm_};
+    }
+
+private:
+    void search(std::vector<int>& prefix, std::vector<bool>& used, Cost cost) {
+        const int k = prefix.size();
+        if (k < n_ && cost + problem_.bound(k, used) >= best_cost_.load()) {
+            return;
+        }
+        if (n_ - k <= walk_size_) {
+            walk(prefix, used, cost);
+            return;
+        }
+
+        for (int v = 0; v < n_; ++v) {
+            if (used[v]) {
+                continue;
+            }
+            used[v] = true;
+            prefix.push_back(v);
+            search(prefix, used, cost + problem_.step(k, prefix[k - 1], v));
+            prefix.pop_back();
+            used[v] = false;
+        }
+    }
+
+    // completes the prefix by the unused elements in ascending order and
+    // walks all their orders
+    void walk(std::vector<int>& prefix, const std::vector<bool>& used, Cost cost) {
+        const int k = prefix.size();
+        for (int v = 0; v < n_; ++v) {
+            if (!used[v]) {
+                cost += problem_.step(prefix.size(), prefix.back(), v);
+                prefix.push_back(v);
+            }
+        }
+        cost += problem_.finish(prefix.front(), prefix.back());
+
+        plain_change_walk(problem_, prefix, k, cost,
+            [this](Cost c, const std::vector<int>& perm) { update(perm, c); });
+        prefix.resize(k);
+    }
+
+    void update(const std::vector<int>& perm, Cost cost) {
+        Cost best = best_cost_.load();
+        while (cost < best) {
+            if (best_cost_.compare_exchange_weak(best, cost)) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                // another thread might have stored a better one meanwhile
+                if (best_perm_.empty() || cost <= best_cost_.load()) {
+                    best_perm_ = perm;
+                }
+                return;
+            }
+        }
+    }
+
+    const Problem& problem_;
+    const int n_;
+    const int walk_size_;
+    std::atomic<Cost> best_cost_;
+    std::mutex mutex_;
+    std::vector<int> best_perm_;
+};
+
+template<typename Problem>
+SearchResult<typename Problem::Cost> branch_and_bound(
+    const Problem& problem, int num_threads = 1,
+    int walk_size = BranchAndBound<Problem>::DEFAULT_WALK_SIZE)
+{
+    return BranchAndBound<Problem>(problem, walk_size)(num_threads);
+}
+
+
+// Exhaustive search without pruning, walking all permutations in
+// plain-change order.
+template<typename Problem>
+SearchResult<typename Problem::Cost> plain_change_search(const Problem& problem)
+{
+    using Cost = typename Problem::Cost;
+    const int n = problem.size();
+
+    std::vector<int> perm(n);
+    Cost cost = 0;
+    for (int k = 0; k < n; ++k) {
+        perm[k] = k;
+        cost += problem.step(k, k - 1, k);
+    }
+    if (n > 0) {
+        cost += problem.finish(0, n - 1);
+    }
+
+    SearchResult<Cost> best{cost, perm};
+    plain_change_walk(problem, perm, 0, cost,
+        [&best](Cost c, const std::vector<int>& p) {
+            if (c < best.cost) {
+                best = {c, p};
+            }
+        });
+    return best;
+}
+
+
+//
+// Problems
+//
+
+// Assignment: position k gets element perm[k] at cost c[k][perm[k]].
+template<typename T>
+class AssignmentProblem {
+public:
+    using Cost = T;
+
+    explicit AssignmentProblem(std::vector<std::vector<T>> c)
+        : c_(std::move(c)), min_suffix_(c_.size() + 1, 0)
+    {
+        // sum of the row minima of rows k, ..., n - 1
+        for (int k = size() - 1; k >= 0; --k) {
+            min_suffix_[k] =
+                min_suffix_[k + 1] + *std::min_element(c_[k].begin(), c_[k].end());
+        }
+    }
+
+    int size() const { return c_.size(); }
+
+    T step(int k, int, int v) const { return c_[k][v]; }
+    T finish(int, int) const { return 0; }
+    T bound(int k, const std::vector<bool>&) const { return min_suffix_[k]; }
+
+    T swap_delta(const std::vector<int>& perm, int i) const {
+        const int a = perm[i];
+        const int b = perm[i + 1];
+        return c_[i][b] + c_[i + 1][a] - c_[i][a] - c_[i + 1][b];
+    }
+
+private:
+    std::vector<std::vector<T>> c_;
+    std::vector<T> min_suffix_;
+};
+
+
+// Travelling salesman: closed tour through all cities in order perm with
+// distances d[u][v].
+template<typename T>
+class TravellingSalesmanProblem {
+public:
+    using Cost = T;
+
+    explicit TravellingSalesmanProblem(std::vector<std::vector<T>> d)
+        : d_(std::move(d)), min_in_(d_.size(), 0)
+    {
+        const int n = size();
+        for (int v = 0; v < n; ++v) {
+            T m = std::numeric_limits<T>::max();
+            for (int u = 0; u < n; ++u) {
+                if (u != v) {
+                    m = std::min(m, d_[u][v]);
+                }
+            }
+            min_in_[v] = n > 1 ? m : 0;
+        }
+    }
+
+    int size() const { return d_.size(); }
+
+    T step(int k, int u, int v) const { return k == 0 ? 0 : d_[u][v]; }
+    T finish(int first, int last) const { return d_[last][first]; }
+
+    // every unused city still has to be entered
+    T bound(int, const std::vector<bool>& used) const {
+        T res = 0;
+        for (int v = 0; v < size(); ++v) {
+            if (!used[v]) {
+                res += min_in_[v];
+            }
+        }
+        return res;
+    }
+
+    T swap_delta(const std::vector<int>& perm, int i) const {
+        const int n = size();
+        if (n < 3) {
+            return 0;
+        }
+        const int p = perm[(i + n - 1) % n];
+        const int a = perm[i];
+        const int b = perm[i + 1];
+        const int q = perm[(i + 2) % n];
+        if (n == 3) {
+            // p == q, all edges are affected
+            return d_[p][b] + d_[b][a] + d_[a][p] - d_[p][a] - d_[a][b] - d_[b][p];
+        }
+        return d_[p][b] + d_[b][a] + d_[a][q] - d_[p][a] - d_[a][b] - d_[b][q];
+    }
+
+private:
+    std::vector<std::vector<T>> d_;
+    std::vector<T> min_in_;
+};
@@ -0,0 +1,219 @@
+#include "point_counting.h"
+#include "polynomial.h"
+#include "ecdh.h"
+
+#include <catch.hpp>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <iostream>
+
+
+// number of points by trying all (x, y)
+template<typename F>
+uint64_t count_points_naive(const F& a, const F& b) {
+    uint64_t count = 1;
+    const uint64_t p = F::characteristic;
+    for (uint64_t x = 0; x < p; ++x) {
+        for (uint64_t y = 0; y < p; ++y) {
+            const F fx = F(x), fy = F(y);
+            if (fy * fy == fx * fx * fx + a * fx + b) {
+                count += 1;
+            }
+        }
+    }
+    return count;
+}
+
+
+TEST_CASE("Arithmetic of polynomials over F7", "[polynomial]") {
+    using F = PF<7>;
+    using Poly = Polynomial<F>;
+
+    const Poly u({1, 2, 3});  // 3x^2 + 2x + 1
+    const Poly v({6, 1});     // x - 1
+
+    REQUIRE(u.degree() == 2);
+    REQUIRE(Poly().degree() == -1);
+    REQUIRE(Poly({1, 2, 0, 0}) == Poly({1, 2}));
+    REQUIRE(u + v == Poly({0, 3, 3}));
+    REQUIRE(u - u == Poly());
+    REQUIRE(u * v == Poly({6, 6, 6, 3}));
+    REQUIRE(u(F(2)) == F(17));
+
+    auto qr = divmod(u, v);
+    REQUIRE(qr.first * v + qr.second == u);
+    REQUIRE(qr.second.degree() < v.degree());
+    REQUIRE(qr.second == Poly(u(F(1))));
+
+    // (x - 1)(x - 2) and (x - 1)(x - 3)
+    const Poly w1 = v * Poly({5, 1});
+    const Poly w2 = v * Poly({4, 1});
+    REQUIRE(gcd(w1, w2) == v);
+    REQUIRE(gcd(w1, Poly({4, 1})) == Poly(F(1)));
+
+    // inverse modulo an irreducible polynomial x^2 + 1 (-1 is no square)
+    const Poly m({1, 0, 1});
+    for (int c0 = 0; c0 < 7; ++c0) {
+        for (int c1 = 0; c1 < 7; ++c1) {
+            const Poly x({c0, c1});
+            auto gs = extended_gcd(x, m);
+            if (x.is_zero()) {
+                REQUIRE(gs.first == m);
+            } else {
+                REQUIRE(gs.first == Poly(F(1)));
+                REQUIRE(gs.second * x % m == Poly(F(1)));
+            }
+        }
+    }
+}
+
+TEST_CASE("Modular exponentiation of polynomials", "[polynomial]") {
+    using F = PF<101>;
+    using Poly = Polynomial<F>;
+
+    const Poly m({3, 1, 4, 1, 5, 9});
+    const Poly x = Poly::monomial(1);
+    Poly power(F(1));
+    for (uint64_t e = 0; e < 40; ++e) {
+        REQUIRE(powmod(x, e, m) == power);
+        REQUIRE(x_powmod(e, m) == power);
+        power = power * x % m;
+    }
+
+    // Fermat: x^p = x in F[x]/(x^p - x)
+    const Poly xp_minus_x = Poly::monomial(101) - x;
+    REQUIRE(x_powmod(uint64_t(101), xp_minus_x) == x);
+}
+
+
+TEST_CASE("Legendre symbols count points like brute force", "[point counting]") {
+    using F = PF<103>;
+    for (int a = 0; a < 10; ++a) {
+        for (int b = 0; b < 10; ++b) {
+            if (4 * a * a * a + 27 * b * b == 0) {
+                continue;
+            }
+            REQUIRE(count_points_legendre(F(a), F(b)) == count_points_naive(F(a), F(b)));
+        }
+    }
+
+    using E61 = EllipticCurve<PF<61>, -1, 0>;
+    REQUIRE(E61::size() == 72);
+    REQUIRE(E61::brute_force_size() == 72);
+}
+
+TEST_CASE("Division polynomials give the multiplication-by-n map",
+    "[point counting]")
+{
+    using F = PF<101>;
+    using E = EllipticCurve<F, 2, 3>;
+    const F a = 2, b = 3;
+    const Polynomial<F> f({b, a, F(0), F(1)});
+    const auto g = division_polynomials(a, b, 12);
+
+    // psi_3 vanishes exactly at the x-coordinates of the points of order 3
+    for (int x = 0; x < 101; ++x) {
+        for (int y = 0; y < 101; ++y) {
+            if (!E::contains(x, y)) {
+                continue;
+            }
+            const auto P = E::Point(x, y);
+            REQUIRE((g[3](x) == F(0)) == (3 * P == E::Point()));
+
+            for (int n = 2; n < 12; ++n) {
+                const auto nP = n * P;
+                // x(nP) = x - psi_(n-1) psi_(n+1) / psi_n^2, where psi_n^2
+                // or psi_(n-1) psi_(n+1) contain y^2 = f
+                F num = g[n - 1](x) * g[n + 1](x);
+                F den = g[n](x) * g[n](x);
+                if (n % 2 == 0) {
+                    den = den * f(x);
+                } else {
+                    num = num * f(x);
+                }
+                REQUIRE((den == F(0)) == nP.identity());
+                if (!nP.identity()) {
+                    REQUIRE(nP.x() == F(x) - num / den);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Schoof's algorithm agrees with Legendre symbols", "[point counting]") {
+    using F = PF<10007>;
+    for (int a = 0; a < 4; ++a) {
+        for (int b = 1; b < 4; ++b) {
+            REQUIRE(count_points_schoof(F(a), F(b)) == count_points_legendre(F(a), F(b)));
+        }
+    }
+
+    using G = PF<1000037>;
+    REQUIRE(count_points_schoof(G(-3), G(7)) == count_points_legendre(G(-3), G(7)));
+    // supersingular, since p = 2 mod 3
+    REQUIRE(count_points_schoof(G(0), G(1)) == 1000038);
+}
+
+TEST_CASE("Schoof's algorithm for 61-bit primes", "[point counting]") {
+    constexpr uint64_t p = (uint64_t(1) << 61) - 1;
+    using F = PF64<p>;
+    using E = EllipticCurve<F, 3, 5>;
+
+    const uint64_t n = E::size();
+    // Hasse: |p + 1 - n| <= 2 sqrt(p) < 2^32
+    REQUIRE(n < p + 1 + (uint64_t(1) << 32));
+    REQUIRE(n + (uint64_t(1) << 32) > p + 1);
+
+    // Lagrange: nP = O for random points P, since p = 3 mod 4 square roots
+    // are powers (p + 1)/4
+    auto pow = [](F x, uint64_t e) {
+        F res = 1;
+        for (; e > 0; e >>= 1, x = x * x) {
+            if (e & 1) {
+                res = res * x;
+            }
+        }
+        return res;
+    };
+    std::mt19937_64 gen(61);
+    int found = 0;
+    while (found < 5) {
+        const F x = F(gen() >> 4);
+        const F y = pow(x * x * x + 3 * x + F(5), (p + 1) / 4);
+        if (!E::contains(x, y)) {
+            continue;
+        }
+        const auto P = E::Point(x, y);
+        REQUIRE(n * P == E::Point());
+        REQUIRE((n + 1) * P == P);
+        found += 1;
+    }
+}
+
+
+// ./point_counting [benchmark]
+TEST_CASE("Legendre symbols vs Schoof's algorithm", "[.][benchmark]") {
+    auto measure = [](const char* name, auto count) {
+        auto start = std::chrono::steady_clock::now();
+        const uint64_t n = count();
+        auto end = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed = end - start;
+        std::cout << name << ": #E = " << n << " in " << elapsed.count() << " s"
+            << std::endl;
+        return n;
+    };
+
+    using F18 = PF<262139>;
+    using F20 = PF<1048573>;
+    using F22 = PF<4194301>;
+    REQUIRE(measure("2^18, Legendre", []() { return count_points_legendre(F18(2), F18(3)); })
+        == measure("2^18, Schoof", []() { return count_points_schoof(F18(2), F18(3)); }));
+    REQUIRE(measure("2^20, Legendre", []() { return count_points_legendre(F20(2), F20(3)); })
+        == measure("2^20, Schoof", []() { return count_points_schoof(F20(2), F20(3)); }));
+    REQUIRE(measure("2^22, Legendre", []() { return count_points_legendre(F22(2), F22(3)); })
+        == measure("2^22, Schoof", []() { return count_points_schoof(F22(2), F22(3)); }));
+
+    using F64 = PF64<uint64_t(-59)>;
+    measure("2^64, Schoof", []() { return count_points_schoof(F64(2), F64(3)); });
+}
@@ -0,0 +1,351 @@
+#pragma once
+
+#include "polynomial.h"
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <assert.h>
+
+//
+// Number of points on y^2 = x^3 + ax + b over a prime field F
+//
+// Every x with x^3 + ax + b a non-zero square gives two points, every root of
+// x^3 + ax + b one point, and there is the point at infinity. Summing the
+// Legendre symbols over all x is O(p).
+//
+// For larger p, Schoof's algorithm computes the trace of Frobenius
+// t = p + 1 - #E(F) modulo small primes l from the action of Frobenius on
+// the l-torsion, and combines them by the Chinese remainder theorem. By
+// Hasse's theorem |t| <= 2 sqrt(p), so primes with product > 4 sqrt(p)
+// suffice. This is polynomial in log p.
+//
+// Cf. R. Schoof, "Elliptic curves over finite fields and the computation of
+// square roots mod p", 1985, and L. C. Washington, "Elliptic Curves: Number
+// Theory and Cryptography", chapter 4.5.
+//
+
+// below this characteristic count_points sums Legendre symbols, above it
+// uses Schoof's algorithm (both take about 15 ms at p ~ 2^20 with -O2, cf.
+// the benchmark in point_counting.cpp)
+constexpr uint64_t SCHOOF_THRESHOLD = uint64_t(1) << 20;
+
+// O(p) time and memory, the quadratic character is read from a table of all
+// squares
+template<typename F>
+uint64_t count_points_legendre(const F& a, const F& b) {
+    const uint64_t p = F::characteristic;
+    std::vector<bool> is_square(p, false);
+    for (uint64_t y = 1; y <= p / 2; ++y) {
+        const F yy = F(y) * F(y);
+        is_square[yy()] = true;
+    }
+
+    uint64_t count = 1;  // point at infinity
+    for (uint64_t x = 0; x < p; ++x) {
+        const F fx = F(x);
+        const F r = (fx * fx + a) * fx + b;
+        count += r == F(0) ? 1 : (is_square[r()] ? 2 : 0);
+    }
+    return count;
+}
+
+
+// Division polynomials
+//
+// The multiplication-by-n map is
+//
+//   nP = (x - psi_(n-1) psi_(n+1) / psi_n^2, psi_(2n) / (2 psi_n^4)).
+//
+// With y^2 = x^3 + ax + b, psi_n is a polynomial in x for odd n and y times
+// a polynomial in x for even n. Returns these polynomials in x, i.e. psi_n
+// for odd n and psi_n / y for even n, for n = 0, ..., max_n.
+template<typename F>
+std::vector<Polynomial<F>> division_polynomials(const F& a, const F& b,
+    int max_n)
+{
+    using Poly = Polynomial<F>;
+    const Poly f({b, a, F(0), F(1)});
+    const Poly ff = f * f;
+
+    std::vector<Poly> g{
+        Poly(),
+        Poly(F(1)),
+        Poly(F(2)),
+        Poly({-a * a, 12 * b, 6 * a, F(0), F(3)}),
+        Poly({-32 * b * b - 4 * a * a * a, -16 * a * b, -20 * a * a, 80 * b,
+            20 * a, F(0), F(4)}),
+    };
+    const F half = F(2).inverse();
+    for (int n = g.size(); n <= max_n; ++n) {
+        const int m = n / 2;
+        if (n % 2 == 1) {
+            // psi_(2m+1) = psi_(m+2) psi_m^3 - psi_(m-1) psi_(m+1)^3, where
+            // the product of the two psi with even index contributes y^4
+            const Poly u = g[m + 2] * g[m] * g[m] * g[m];
+            const Poly v = g[m - 1] * g[m + 1] * g[m + 1] * g[m + 1];
+            g.push_back(m % 2 == 0 ? ff * u - v : u - ff * v);
+        } else {
+            // psi_(2m) = psi_m / 2y (psi_(m+2) psi_(m-1)^2 - psi_(m-2) psi_(m+1)^2)
+            g.push_back(half * (g[m] * (g[m + 2] * g[m - 1] * g[m - 1]
+                - g[m - 2] * g[m + 1] * g[m + 1])));
+        }
+    }
+    g.erase(g.begin() + std::min<size_t>(max_n + 1, g.size()), g.end());
+    return g;
+}
+
+
+template<typename F>
+class Schoof {
+public:
+    using Poly = Polynomial<F>;
+
+    Schoof(const F& a, const F& b)
+        : a_(a), b_(b), f_({b, a, F(0), F(1)})
+    {}
+
+    uint64_t operator()() const {
+        const uint64_t p = F::characteristic;
+        using u128 = unsigned __int128;
+
+        // t mod 2 is 0 iff there is a point of order 2, i.e. iff
+        // x^3 + ax + b has a root, i.e. iff gcd(x^p - x, x^3 + ax + b) != 1
+        const Poly xp = x_powmod(p, f_);
+        u128 t = gcd(xp - Poly::monomial(1), f_).degree() > 0 ? 0 : 1;
+        u128 modulus = 2;
+
+        std::vector<int> primes;
+        for (int l = 3; modulus * modulus <= 16 * u128(p); l += 2) {
+            if (!is_prime(l) || uint64_t(l) == p) {
+                continue;
+            }
+            primes.push_back(l);
+            modulus *= l;
+        }
+        const auto psi = division_polynomials(a_, b_, primes.empty() ? 0 : primes.back());
+
+        // Chinese remainder theorem
+        modulus = 2;
+        for (int l : primes) {
+            const u128 tl = trace_mod(l, psi[l]);
+            while (t % l != tl) {
+                t += modulus;
+            }
+            modulus *= l;
+        }
+
+        // |t| <= 2 sqrt(p) < modulus / 2
+        const u128 count = t <= modulus / 2 ? u128(p) + 1 - t : u128(p) + 1 + (modulus - t);
+        assert(count >> 64 == 0);
+        return static_cast<uint64_t>(count);
+    }
+
+private:
+    // A non-trivial factor of the modulus was found while inverting.
+    struct ZeroDivisor {
+        Poly factor;
+    };
+
+    // point (x, y y) in E(F[x]/h, y^2 = x^3 + ax + b), the y coordinate is
+    // stored as a polynomial in x multiplied by y
+    struct Point {
+        bool infinity;
+        Poly x, y;
+    };
+
+    // Arithmetic modulo a factor h of psi_l, which plays the role of the
+    // l-torsion. The group law needs inverses which fail to exist if h is
+    // not irreducible; then h is split and everything is repeated with the
+    // smaller factor, which still describes a non-zero subset of the
+    // l-torsion closed under Frobenius.
+    class Ring {
+    public:
+        Ring(const Poly& h, const F& a, const Poly& f)
+            : h_(h), a_(a), f_(f % h)
+        {}
+
+        Poly mul(const Poly& u, const Poly& v) const { return u * v % h_; }
+
+        // throws ZeroDivisor if u != 0 is not invertible
+        bool is_zero(const Poly& u) const {
+            const Poly r = u % h_;
+            if (r.is_zero()) {
+                return true;
+            }
+            const Poly g = gcd(r, h_);
+            if (g.degree() > 0) {
+                throw ZeroDivisor{g};
+            }
+            return false;
+        }
+
+        Poly inverse(const Poly& u) const {
+            const auto gs = extended_gcd(u, h_);
+            assert(!gs.first.is_zero());
+            if (gs.first.degree() > 0) {
+                throw ZeroDivisor{gs.first};
+            }
+            return gs.second;
+        }
+
+        Point add(const Point& P, const Point& Q) const {
+            if (P.infinity) {
+                return Q;
+            } else if (Q.infinity) {
+                return P;
+            }
+
+            if (is_zero(Q.x - P.x)) {
+                if (is_zero(Q.y - P.y)) {
+                    return dbl(P);
+                }
+                if (is_zero(Q.y + P.y)) {
+                    return {true, Poly(), Poly()};
+                }
+                // cannot happen: (Q.y - P.y)(Q.y + P.y) f = 0 and f is
+                // coprime to psi_l, so one of them is a zero divisor
+                assert(false);
+            }
+
+            // lambda = (Q.y - P.y) y / (Q.x - P.x)
+            const Poly lambda = mul(Q.y - P.y, inverse(Q.x - P.x));
+            return chord(P, Q, lambda);
+        }
+
+        Point dbl(const Point& P) const {
+            if (P.infinity || is_zero(P.y)) {
+                return {true, Poly(), Poly()};
+            }
+            // lambda = (3x^2 + a) / (2 y y) = (3x^2 + a) y / (2 y f)
+            const Poly num = F(3) * mul(P.x, P.x) + Poly(a_);
+            const Poly lambda = mul(num, inverse(mul(F(2) * P.y, f_)));
+            return chord(P, P, lambda);
+        }
+
+        Point neg(const Point& P) const { return {P.infinity, P.x, -P.y}; }
+
+        Point mult(int k, const Point& P) const {
+            Point res{true, Poly(), Poly()};
+            for (int i = 31; i >= 0; --i) {
+                res = dbl(res);
+                if ((k >> i) & 1) {
+                    res = add(res, P);
+                }
+            }
+            return res;
+        }
+
+        bool equal(const Point& P, const Point& Q) const {
+            if (P.infinity || Q.infinity) {
+                return P.infinity == Q.infinity;
+            }
+            return is_zero(P.x - Q.x) && is_zero(P.y - Q.y);
+        }
+
+        const Poly& modulus() const { return h_; }
+
+    private:
+        // third intersection with the line of slope lambda y, mirrored
+        Point chord(const Point& P, const Point& Q, const Poly& lambda) const {
+            const Poly x3 = (mul(mul(lambda, lambda), f_) - P.x - Q.x) % h_;
+            const Poly y3 = (mul(lambda, P.x - x3) - P.y) % h_;
+            return {false, x3, y3};
+        }
+
+        Poly h_;
+        F a_;
+        Poly f_;
+    };
+
+    // t mod l for an odd prime l != p
+    uint64_t trace_mod(int l, const Poly& psi) const {
+        Poly h = psi.monic();
+        while (true) {
+            try {
+                return trace_mod(l, Ring(h, a_, f_));
+            } catch (const ZeroDivisor& e) {
+                // continue with the smaller factor
+                const Poly g = e.factor.monic();
+                const Poly cofactor = (h / g).monic();
+                h = g.degree() <= cofactor.degree() ? g : cofactor;
+            }
+        }
+    }
+
+    uint64_t trace_mod(int l, const Ring& R) const {
+        const uint64_t p = F::characteristic;
+        const Poly& h = R.modulus();
+        const int q = p % l;
+
+        // Frobenius (x^p, y^p) = (x^p, f^((p - 1)/2) y) and its square
+        const Poly xp = x_powmod(p, h);
+        const Poly yp = powmod(f_, (p - 1) / 2, h);
+        const Point frob{false, xp, yp};
+        const Point frob2{false, powmod(xp, p, h), R.mul(powmod(yp, p, h), yp)};
+
+        const Point P{false, Poly::monomial(1) % h, Poly(F(1))};
+        const Point qP = R.mult(q, P);
+
+        // frob^2 - t frob + q = 0 on the l-torsion
+        if (R.is_zero(frob2.x - qP.x)) {
+            if (!R.is_zero(frob2.y - qP.y)) {
+                // frob^2 P = -q P, so t frob P = 0
+                return 0;
+            }
+
+            // frob^2 P = q P, so frob has an eigenvalue w with w^2 = q and
+            // t = 2w, or t = 0
+            int w = 1;
+            while (w < l && (w * w) % l != q) {
+                w += 1;
+            }
+            if (w == l) {
+                return 0;
+            }
+            const Point wP = R.mult(w, P);
+            if (!R.is_zero(frob.x - wP.x)) {
+                return 0;
+            }
+            return R.is_zero(frob.y - wP.y) ? (2 * w) % l : l - (2 * w) % l;
+        }
+
+        // look for tau with tau frob P = frob^2 P + q P
+        const Point Q = R.add(frob2, qP);
+        Point tau_frob = frob;
+        for (int tau = 1; tau <= (l - 1) / 2; ++tau) {
+            if (R.is_zero(tau_frob.x - Q.x)) {
+                return R.is_zero(tau_frob.y - Q.y) ? tau : l - tau;
+            }
+            tau_frob = R.add(tau_frob, frob);
+        }
+        assert(false);
+        return 0;
+    }
+
+    static bool is_prime(int n) {
+        for (int d = 2; d * d <= n; ++d) {
+            if (n % d == 0) {
+                return false;
+            }
+        }
+        return n > 1;
+    }
+
+    F a_, b_;
+    Poly f_;
+};
+
+template<typename F>
+uint64_t count_points_schoof(const F& a, const F& b) {
+    return Schoof<F>(a, b)();
+}
+
+template<typename F>
+uint64_t count_points(const F& a, const F& b) {
+    return static_cast<uint64_t>(F::characteristic) < SCHOOF_THRESHOLD
+        ? count_points_legendre(a, b)
+        : count_points_schoof(a, b);
+}
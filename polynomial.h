@@ -0,0 +1,227 @@
+#pragma once
+
+#include <vector>
+#include <ostream>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <assert.h>
+
+//
+// Polynomials over a field F
+//
+// Coefficients are stored lowest degree first without leading zeros, so the
+// zero polynomial has no coefficients and degree -1. Multiplication and
+// division are schoolbook, i.e. quadratic in the degree.
+//
+template<typename F>
+class Polynomial {
+public:
+    Polynomial() {}
+    // constant polynomial
+    Polynomial(const F& c) : c_{c} { normalize(); }
+    explicit Polynomial(std::vector<F> c) : c_(std::move(c)) { normalize(); }
+
+    // c x^n
+    static Polynomial monomial(size_t n, const F& c = F(1)) {
+        std::vector<F> coeffs(n + 1, F(0));
+        coeffs[n] = c;
+        return Polynomial(std::move(coeffs));
+    }
+
+    int degree() const { return static_cast<int>(c_.size()) - 1; }
+    bool is_zero() const { return c_.empty(); }
+    const std::vector<F>& coefficients() const { return c_; }
+
+    const F operator[](size_t i) const { return i < c_.size() ? c_[i] : F(0); }
+
+    const F leading() const {
+        assert(!is_zero());
+        return c_.back();
+    }
+
+    // value at x, Horner's scheme
+    const F operator()(const F& x) const {
+        F res = 0;
+        for (auto it = c_.rbegin(); it != c_.rend(); ++it) {
+            res = res * x + *it;
+        }
+        return res;
+    }
+
+    const Polynomial monic() const {
+        return is_zero() ? *this : leading().inverse() * *this;
+    }
+
+    const Polynomial operator-() const {
+        std::vector<F> res(c_.size(), F(0));
+        for (size_t i = 0; i < c_.size(); ++i) {
+            res[i] = -c_[i];
+        }
+        return Polynomial(std::move(res));
+    }
+
+    friend const Polynomial operator+(const Polynomial& u, const Polynomial& v) {
+        std::vector<F> res(std::max(u.c_.size(), v.c_.size()), F(0));
+        for (size_t i = 0; i < res.size(); ++i) {
+            res[i] = u[i] + v[i];
+        }
+        return Polynomial(std::move(res));
+    }
+
+    friend const Polynomial operator-(const Polynomial& u, const Polynomial& v) {
+        std::vector<F> res(std::max(u.c_.size(), v.c_.size()), F(0));
+        for (size_t i = 0; i < res.size(); ++i) {
+            res[i] = u[i] - v[i];
+        }
+        return Polynomial(std::move(res));
+    }
+
+    friend const Polynomial operator*(const Polynomial& u, const Polynomial& v) {
+        if (u.is_zero() || v.is_zero()) {
+            return Polynomial();
+        }
+        std::vector<F> res(u.c_.size() + v.c_.size() - 1, F(0));
+        for (size_t i = 0; i < u.c_.size(); ++i) {
+            for (size_t j = 0; j < v.c_.size(); ++j) {
+                res[i + j] = res[i + j] + u.c_[i] * v.c_[j];
+            }
+        }
+        return Polynomial(std::move(res));
+    }
+
+    friend const Polynomial operator*(const F& c, const Polynomial& v) {
+        std::vector<F> res(v.c_);
+        for (auto& x : res) {
+            x = c * x;
+        }
+        return Polynomial(std::move(res));
+    }
+
+    // quotient and remainder
+    friend std::pair<Polynomial, Polynomial> divmod(const Polynomial& u,
+        const Polynomial& v)
+    {
+        assert(!v.is_zero());
+        if (u.degree() < v.degree()) {
+            return {Polynomial(), u};
+        }
+
+        const F inv = v.leading().inverse();
+        const int n = v.degree();
+        std::vector<F> r(u.c_);
+        std::vector<F> q(u.degree() - n + 1, F(0));
+        for (int k = u.degree() - n; k >= 0; --k) {
+            const F c = r[k + n] * inv;
+            q[k] = c;
+            for (int j = 0; j <= n; ++j) {
+                r[k + j] = r[k + j] - c * v.c_[j];
+            }
+        }
+        r.erase(r.begin() + n, r.end());
+        return {Polynomial(std::move(q)), Polynomial(std::move(r))};
+    }
+
+    friend const Polynomial operator/(const Polynomial& u, const Polynomial& v) {
+        return divmod(u, v).first;
+    }
+
+    friend const Polynomial operator%(const Polynomial& u, const Polynomial& v) {
+        return divmod(u, v).second;
+    }
+
+    friend bool operator==(const Polynomial& u, const Polynomial& v) {
+        return u.c_.size() == v.c_.size()
+            && std::equal(u.c_.begin(), u.c_.end(), v.c_.begin());
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const Polynomial& u) {
+        if (u.is_zero()) {
+            return os << "0";
+        }
+        for (int i = u.degree(); i >= 0; --i) {
+            os << u.c_[i];
+            if (i > 0) {
+                os << " x^" << i << " + ";
+            }
+        }
+        return os;
+    }
+
+private:
+    void normalize() {
+        while (!c_.empty() && c_.back() == F(0)) {
+            c_.pop_back();
+        }
+    }
+
+    std::vector<F> c_;
+};
+
+
+// monic greatest common divisor g and s with s u = g (mod m)
+template<typename F>
+std::pair<Polynomial<F>, Polynomial<F>> extended_gcd(const Polynomial<F>& u,
+    const Polynomial<F>& m)
+{
+    // invariant: s0 u = r0, s1 u = r1 (mod m)
+    Polynomial<F> r0 = m, r1 = u % m;
+    Polynomial<F> s0, s1 = F(1);
+    while (!r1.is_zero()) {
+        auto qr = divmod(r0, r1);
+        r0 = std::move(r1);
+        r1 = std::move(qr.second);
+        auto s = s0 - qr.first * s1;
+        s0 = std::move(s1);
+        s1 = std::move(s);
+    }
+    if (r0.is_zero()) {
+        return {r0, s0};
+    }
+    const F inv = r0.leading().inverse();
+    return {inv * r0, inv * s0 % m};
+}
+
+template<typename F>
+Polynomial<F> gcd(const Polynomial<F>& u, const Polynomial<F>& v) {
+    Polynomial<F> r0 = u, r1 = v;
+    while (!r1.is_zero()) {
+        auto r = r0 % r1;
+        r0 = std::move(r1);
+        r1 = std::move(r);
+    }
+    return r0.monic();
+}
+
+// u^e mod m, binary method
+template<typename F, typename Int>
+Polynomial<F> powmod(const Polynomial<F>& u, Int e, const Polynomial<F>& m) {
+    Polynomial<F> res = Polynomial<F>(F(1)) % m;
+    Polynomial<F> base = u % m;
+    for (; e > 0; e >>= 1) {
+        if (e & 1) {
+            res = res * base % m;
+        }
+        base = base * base % m;
+    }
+    return res;
+}
+
+// x^e mod m, left to right, so that the multiplications by x are shifts
+template<typename F, typename Int>
+Polynomial<F> x_powmod(Int e, const Polynomial<F>& m) {
+    int top = -1;
+    for (Int k = e; k > 0; k >>= 1) {
+        top += 1;
+    }
+
+    Polynomial<F> res = Polynomial<F>(F(1)) % m;
+    for (int i = top; i >= 0; --i) {
+        res = res * res % m;
+        if ((e >> i) & 1) {
+            res = Polynomial<F>::monomial(1) * res % m;
+        }
+    }
+    return res;
+}
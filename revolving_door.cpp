@@ -0,0 +1,144 @@
+#include "revolving_door.h"
+
+#include <catch.hpp>
+#include <vector>
+#include <set>
+#include <thread>
+#include <numeric>
+#include <algorithm>
+
+
+TEST_CASE("Revolving door of 2-subsets of 4 elements", "[revolving_door]") {
+    RevolvingDoor gen(4, 2);
+    std::vector<std::vector<int>> result{gen.to_vector()};
+    while (gen.next()) {
+        result.push_back(gen.to_vector());
+    }
+
+    REQUIRE(result == (std::vector<std::vector<int>>{
+        {0, 1}, {1, 2}, {0, 2}, {2, 3}, {1, 3}, {0, 3}}));
+}
+
+TEST_CASE("Trivial revolving doors", "[revolving_door]") {
+    RevolvingDoor empty(5, 0);
+    REQUIRE(empty.to_vector() == (std::vector<int>{}));
+    REQUIRE(!empty.next());
+
+    RevolvingDoor full(3, 3);
+    REQUIRE(full.to_vector() == (std::vector<int>{0, 1, 2}));
+    REQUIRE(!full.next());
+
+    RevolvingDoor singletons(3, 1);
+    REQUIRE(singletons.next());
+    REQUIRE(singletons.to_vector() == (std::vector<int>{1}));
+    REQUIRE(singletons.next());
+    REQUIRE(singletons.to_vector() == (std::vector<int>{2}));
+    REQUIRE(!singletons.next());
+}
+
+TEST_CASE("Every step swaps one element and visits all subsets",
+    "[revolving_door]")
+{
+    for (int n = 1; n < 10; ++n) {
+        for (int t = 0; t <= n; ++t) {
+            RevolvingDoor gen(n, t);
+            std::set<std::vector<int>> visited{gen.to_vector()};
+            uint64_t rank = 0;
+            REQUIRE(revolving_door_rank(gen.to_vector()) == rank);
+
+            auto prev = gen.to_vector();
+            while (gen.next()) {
+                auto comb = gen.to_vector();
+                REQUIRE(std::is_sorted(comb.begin(), comb.end()));
+
+                // prev - out + in == comb
+                auto expected = prev;
+                auto it = std::find(expected.begin(), expected.end(), gen.out());
+                REQUIRE(it != expected.end());
+                *it = gen.in();
+                std::sort(expected.begin(), expected.end());
+                REQUIRE(expected == comb);
+
+                rank += 1;
+                REQUIRE(revolving_door_rank(comb) == rank);
+                REQUIRE(revolving_door_unrank(rank, n, t) == comb);
+
+                visited.insert(comb);
+                prev = comb;
+            }
+            REQUIRE(visited.size() == binomial(n, t));
+        }
+    }
+}
+
+TEST_CASE("Ranks of 32-subsets of 64 elements", "[revolving_door]") {
+    REQUIRE(binomial(63, 29) == 759510004936100355ULL);
+    REQUIRE(binomial(64, 32) == 1832624140942590534ULL);
+    REQUIRE(binomial(64, 64) == 1);
+
+    // the last three combinations
+    const uint64_t last = binomial(64, 32) - 1;
+    RevolvingDoor gen(64, 32, last - 2);
+    for (uint64_t rank = last - 2; ; ++rank) {
+        const auto comb = gen.to_vector();
+        REQUIRE(comb.size() == 32);
+        REQUIRE(std::is_sorted(comb.begin(), comb.end()));
+        REQUIRE(comb.back() == 63);
+        REQUIRE(revolving_door_rank(comb) == rank);
+        REQUIRE(revolving_door_unrank(rank, 64, 32) == comb);
+        if (rank == last) {
+            break;
+        }
+        REQUIRE(gen.next());
+    }
+    REQUIRE(!gen.next());
+
+    for (uint64_t rank : {uint64_t(0), last / 3, last / 2, last - 1000}) {
+        REQUIRE(revolving_door_rank(revolving_door_unrank(rank, 64, 32)) == rank);
+    }
+}
+
+TEST_CASE("Update sum of subsets in O(1) and split ranks across threads",
+    "[revolving_door]")
+{
+    const int n = 20;
+    const int t = 7;
+    std::vector<int64_t> weights(n);
+    std::iota(weights.begin(), weights.end(), 1);
+
+    auto sum_of_sums = [&weights](RevolvingDoor gen, uint64_t count) {
+        int64_t sum = 0;
+        for (auto i : gen) {
+            sum += weights[i];
+        }
+        int64_t total = 0;
+        for (uint64_t k = 0; k < count; ++k) {
+            total += sum;
+            if (gen.next()) {
+                sum += weights[gen.in()] - weights[gen.out()];
+            }
+        }
+        return total;
+    };
+
+    // each element is in C(n - 1, t - 1) subsets
+    const int64_t expected = binomial(n - 1, t - 1) * (n * (n + 1) / 2);
+    const uint64_t total = binomial(n, t);
+    REQUIRE(sum_of_sums(RevolvingDoor(n, t), total) == expected);
+
+    const int threads = 4;
+    std::vector<int64_t> partial(threads, 0);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back([&, i]() {
+            const uint64_t from = total * i / threads;
+            const uint64_t to = total * (i + 1) / threads;
+            partial[i] = sum_of_sums(RevolvingDoor(n, t, from), to - from);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    REQUIRE(std::accumulate(partial.begin(), partial.end(), int64_t(0)) ==
+        expected);
+}
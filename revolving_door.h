@@ -0,0 +1,153 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <assert.h>
+
+//
+// Revolving-door combinations
+//
+// Generates all t-subsets of {0, ..., n - 1} in the revolving-door Gray code
+// order, where each step removes exactly one element and adds exactly one.
+// The order is defined recursively by
+//
+//   Γ(n, t) = Γ(n - 1, t), reverse(Γ(n - 1, t - 1)) ∪ {n - 1}.
+//
+// Cf. Knuth, TAOCP 7.2.1.3, Algorithm R. Only the state c_1, ..., c_t is
+// kept, so a generator can start at any combination given by its rank.
+//
+
+// binomial coefficient, 0 if k < 0 or k > n; it has to fit into 64 bits
+inline uint64_t binomial(int n, int k) {
+    if (k < 0 || k > n) {
+        return 0;
+    }
+    if (k > n - k) {
+        k = n - k;
+    }
+    // res = C(n, i) < 2^64 before each step, so res * (n - i) fits into
+    // 128 bits even where it does not fit into 64
+    unsigned __int128 res = 1;
+    for (int i = 0; i < k; ++i) {
+        res = res * (n - i) / (i + 1);
+        assert(res <= UINT64_MAX);
+    }
+    return static_cast<uint64_t>(res);
+}
+
+// rank of comb (sorted ascending) in revolving-door order
+//
+// rank(c_1 < ... < c_t) = C(c_t + 1, t) - 1 - rank(c_1 < ... < c_{t-1})
+inline uint64_t revolving_door_rank(const std::vector<int>& comb) {
+    uint64_t rank = 0;
+    for (int j = 0; j < static_cast<int>(comb.size()); ++j) {
+        rank = binomial(comb[j] + 1, j + 1) - 1 - rank;
+    }
+    return rank;
+}
+
+// inverse of revolving_door_rank
+inline std::vector<int> revolving_door_unrank(uint64_t rank, int n, int t) {
+    assert(0 <= t && t <= n && rank < binomial(n, t));
+    std::vector<int> comb(t);
+    int m = n - 1;
+    for (int j = t; j > 0; --j) {
+        // the combinations with largest element m have ranks in
+        // [C(m, j), C(m + 1, j))
+        while (binomial(m, j) > rank) {
+            m -= 1;
+        }
+        comb[j - 1] = m;
+        rank = binomial(m + 1, j) - 1 - rank;
+        m -= 1;
+    }
+    return comb;
+}
+
+
+class RevolvingDoor {
+public:
+    // starts at the combination with the given rank, so that enumeration
+    // can be split into independent ranges of ranks
+    RevolvingDoor(int n, int t, uint64_t rank = 0)
+        : n_(n), t_(t), c_(t + 2, 0)
+    {
+        assert(0 <= t && t <= n);
+        const auto comb = revolving_door_unrank(rank, n, t);
+        for (int j = 1; j <= t; ++j) {
+            c_[j] = comb[j - 1];
+        }
+        c_[t + 1] = n;
+    }
+
+    int n() const { return n_; }
+    int t() const { return t_; }
+
+    // elements in ascending order
+    int operator[](int i) const { return c_[i + 1]; }
+    const int* begin() const { return c_.data() + 1; }
+    const int* end() const { return c_.data() + 1 + t_; }
+    std::vector<int> to_vector() const { return {begin(), end()}; }
+
+    // element removed and element added by the last call of next()
+    int out() const { return out_; }
+    int in() const { return in_; }
+
+    // advance to the next combination, returns false on the last one
+    bool next() {
+        auto& c = c_;
+        const int t = t_;
+        if (t == 0 || t == n_) {
+            return false;
+        }
+
+        // easy case: move c_1 up (t odd) or down (t even)
+        if (t % 2 == 1 && c[1] + 1 < c[2]) {
+            out_ = c[1]++;
+            in_ = c[1];
+            return true;
+        } else if (t % 2 == 0 && c[1] > 0) {
+            out_ = c[1]--;
+            in_ = c[1];
+            return true;
+        }
+
+        int j = 2;
+        bool decrease = t % 2 == 1;
+        while (j <= t) {
+            if (decrease) {
+                // try to decrease c_j, here c_j = c_{j-1} + 1
+                if (c[j] >= j) {
+                    out_ = c[j];
+                    in_ = j - 2;
+                    c[j] = c[j - 1];
+                    c[j - 1] = j - 2;
+                    return true;
+                }
+                j += 1;
+                if (j > t) {
+                    break;
+                }
+            }
+
+            // try to increase c_j, here c_{j-1} = j - 2
+            if (c[j] + 1 < c[j + 1]) {
+                out_ = j - 2;
+                in_ = c[j] + 1;
+                c[j - 1] = c[j];
+                c[j] += 1;
+                return true;
+            }
+            j += 1;
+            decrease = true;
+        }
+        return false;
+    }
+
+private:
+    int n_;
+    int t_;
+    std::vector<int> c_;  // 1-based, c_[t + 1] = n is a sentinel
+    int out_ = -1;
+    int in_ = -1;
+};
@@ -0,0 +1,133 @@
+#include "shuffle.h"
+#include "inversions.h"
+#include "next_permutation.h"
+
+#include <catch.hpp>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+
+bool is_permutation_of_range(const std::vector<int>& seq) {
+    std::vector<bool> seen(seq.size(), false);
+    for (auto x : seq) {
+        if (x < 0 || static_cast<size_t>(x) >= seq.size() || seen[x]) {
+            return false;
+        }
+        seen[x] = true;
+    }
+    return true;
+}
+
+// chi-squared statistic of the frequencies of all permutations of
+// {0, ..., n - 1}
+template<typename Shuffle>
+double chi_squared(int n, int samples, Shuffle shuffle) {
+    std::map<std::vector<int>, int> counts;
+    for (int s = 0; s < samples; ++s) {
+        std::vector<int> seq(n);
+        for (int i = 0; i < n; ++i) {
+            seq[i] = i;
+        }
+        shuffle(seq, s + 1);
+        counts[seq] += 1;
+    }
+
+    int permutations = 1;
+    for (int i = 2; i <= n; ++i) {
+        permutations *= i;
+    }
+    REQUIRE(counts.size() == static_cast<size_t>(permutations));
+
+    const double expected = static_cast<double>(samples) / permutations;
+    double chi2 = 0;
+    for (const auto& kv : counts) {
+        chi2 += (kv.second - expected) * (kv.second - expected) / expected;
+    }
+    return chi2;
+}
+
+
+TEST_CASE("Random integers below a bound", "[shuffle]") {
+    xorshift64star<uint64_t> gen(1);
+    std::vector<int> counts(3, 0);
+    for (int i = 0; i < 30000; ++i) {
+        counts[random_below(gen, 3)] += 1;
+    }
+    for (auto c : counts) {
+        REQUIRE(9500 < c);
+        REQUIRE(c < 10500);
+    }
+    REQUIRE(random_below(gen, 1) == 0);
+}
+
+TEST_CASE("Fisher-Yates and MergeShuffle are uniform", "[shuffle]") {
+    // 23 degrees of freedom, P(chi2 > 60) < 1e-4
+    auto fy = chi_squared(4, 24000, [](std::vector<int>& seq, uint64_t seed) {
+        xorshift64star<uint64_t> gen(seed);
+        fisher_yates(seq.begin(), seq.end(), gen);
+    });
+    REQUIRE(fy < 60);
+
+    // blocks of a single element, i.e. everything is done by merges
+    auto ms = chi_squared(4, 24000, [](std::vector<int>& seq, uint64_t seed) {
+        merge_shuffle(seq.begin(), seq.end(), seed, 1, 1);
+    });
+    REQUIRE(ms < 60);
+
+    // uneven blocks
+    auto uneven = chi_squared(5, 60000, [](std::vector<int>& seq, uint64_t seed) {
+        merge_shuffle(seq.begin(), seq.end(), seed, 2, 2);
+    });
+    REQUIRE(uneven < 180);  // 119 degrees of freedom
+}
+
+TEST_CASE("MergeShuffle does not depend on the number of threads",
+    "[shuffle]")
+{
+    const size_t n = 1000003;
+    std::vector<int> seq(n);
+    for (size_t i = 0; i < n; ++i) {
+        seq[i] = i;
+    }
+
+    auto serial = seq;
+    merge_shuffle(serial.begin(), serial.end(), 42, 1, 1000);
+    REQUIRE(is_permutation_of_range(serial));
+    REQUIRE(serial != seq);
+
+    for (int threads : {2, 3, 8}) {
+        auto parallel = seq;
+        merge_shuffle(parallel.begin(), parallel.end(), 42, threads, 1000);
+        REQUIRE(parallel == serial);
+    }
+
+    auto other = seq;
+    merge_shuffle(other.begin(), other.end(), 43, 4, 1000);
+    REQUIRE(other != serial);
+}
+
+TEST_CASE("Random permutations feed the permutation algorithms",
+    "[shuffle]")
+{
+    REQUIRE(random_permutation(0, 1).empty());
+    REQUIRE(random_permutation(1, 1) == (std::vector<int>{0}));
+
+    auto seq = random_permutation(300000, 7, 4);
+    REQUIRE(is_permutation_of_range(seq));
+    auto inversions = count_inversions_fenwick(seq.begin(), seq.end());
+    REQUIRE(sgn_cycles(seq.begin(), seq.end()) ==
+        (inversions % 2 == 0 ? 1 : -1));
+
+    // expected number of inversions is n(n - 1)/4
+    const double expected = 300000.0 * 299999.0 / 4;
+    REQUIRE(std::abs(inversions - expected) < 0.01 * expected);
+
+    auto small = random_permutation(6, 7);
+    REQUIRE(is_permutation_of_range(small));
+    int count = 1;
+    while (next_permutation(small)) {
+        count += 1;
+    }
+    REQUIRE(count <= 720);
+}
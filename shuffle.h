@@ -0,0 +1,175 @@
+#pragma once
+
+#include "xorshift.h"
+
+#include <vector>
+#include <thread>
+#include <iterator>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <assert.h>
+
+//
+// Uniform random permutations
+//
+// Fisher-Yates is inherently serial and for large arrays every swap is a
+// cache miss. MergeShuffle (Bacher, Bodini, Hollender, Lumbroso, 2015)
+// shuffles small blocks independently and merges them pairwise with random
+// bits, which is cache-friendly and parallelizes over the blocks.
+//
+
+// seeds of independent streams, cf. splitmix64
+inline uint64_t stream_seed(uint64_t seed, uint64_t stream) {
+    uint64_t z = seed + (stream + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    return z != 0 ? z : 1;  // xorshift64star needs a non-zero seed
+}
+
+// unbiased integer in [0, bound), cf. Lemire, "Fast Random Integer
+// Generation in an Interval", 2019
+template<typename Gen>
+uint64_t random_below(Gen& gen, uint64_t bound) {
+    assert(bound > 0);
+    unsigned __int128 m = static_cast<unsigned __int128>(gen()) * bound;
+    uint64_t low = static_cast<uint64_t>(m);
+    if (low < bound) {
+        const uint64_t threshold = -bound % bound;
+        while (low < threshold) {
+            m = static_cast<unsigned __int128>(gen()) * bound;
+            low = static_cast<uint64_t>(m);
+        }
+    }
+    return m >> 64;
+}
+
+// source of single random bits, consuming one 64-bit output per 64 bits
+template<typename Gen>
+class RandomBits {
+public:
+    explicit RandomBits(Gen& gen) : gen_(gen) {}
+
+    bool operator()() {
+        if (left_ == 0) {
+            bits_ = gen_();
+            left_ = 64;
+        }
+        const bool bit = bits_ & 1;
+        bits_ >>= 1;
+        left_ -= 1;
+        return bit;
+    }
+
+private:
+    Gen& gen_;
+    uint64_t bits_ = 0;
+    int left_ = 0;
+};
+
+
+template<typename Iter, typename Gen>
+void fisher_yates(Iter begin, Iter end, Gen& gen) {
+    const size_t n = std::distance(begin, end);
+    for (size_t i = n; i > 1; --i) {
+        std::iter_swap(begin + (i - 1), begin + random_below(gen, i));
+    }
+}
+
+// Merges the shuffled ranges [begin, mid) and [mid, end) into a shuffled
+// range [begin, end). While both ranges are non-empty, a random bit decides
+// from which one the next element is taken; the rest is inserted at random
+// positions like in Fisher-Yates.
+template<typename Iter, typename Gen>
+void merge_shuffled(Iter begin, Iter mid, Iter end, Gen& gen) {
+    RandomBits<Gen> bit(gen);
+    Iter i = begin;
+    Iter j = mid;
+    while (true) {
+        if (bit()) {
+            if (j == end) {
+                break;
+            }
+            std::iter_swap(i, j);
+            ++j;
+        } else if (i == j) {
+            break;
+        }
+        ++i;
+    }
+
+    for (; i != end; ++i) {
+        const size_t k = std::distance(begin, i);
+        std::iter_swap(i, begin + random_below(gen, k + 1));
+    }
+}
+
+
+// Shuffles [begin, end) with MergeShuffle on num_threads threads.
+//
+// The range is split into blocks of at most block_size elements which are
+// shuffled by Fisher-Yates and then merged pairwise, level by level. Every
+// block and every merge has its own xorshift64star stream derived from seed
+// and the position of the block, so the result depends only on seed and
+// block_size, not on num_threads.
+template<typename Iter>
+void merge_shuffle(Iter begin, Iter end, uint64_t seed, int num_threads = 1,
+    size_t block_size = 1 << 16)
+{
+    assert(num_threads > 0 && block_size > 0);
+    const size_t n = std::distance(begin, end);
+
+    size_t blocks = 1;
+    while (n / blocks > block_size) {
+        blocks *= 2;
+    }
+
+    // runs task(0), ..., task(count - 1) on the threads
+    auto parallel = [num_threads](size_t count, auto task) {
+        const size_t num_workers = std::min<size_t>(num_threads, count);
+        std::vector<std::thread> workers;
+        for (size_t w = 1; w < num_workers; ++w) {
+            workers.emplace_back([=]() {
+                for (size_t t = w; t < count; t += num_workers) {
+                    task(t);
+                }
+            });
+        }
+        for (size_t t = 0; t < count; t += num_workers) {
+            task(t);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    };
+
+    // block b is [bound(b), bound(b + 1))
+    auto bound = [begin, n, blocks](size_t b) { return begin + n * b / blocks; };
+
+    parallel(blocks, [=](size_t b) {
+        xorshift64star<uint64_t> gen(stream_seed(seed, b));
+        fisher_yates(bound(b), bound(b + 1), gen);
+    });
+
+    for (size_t width = 1; width < blocks; width *= 2) {
+        parallel(blocks / (2 * width), [=](size_t m) {
+            const size_t b = 2 * width * m;
+            xorshift64star<uint64_t> gen(stream_seed(seed, blocks * width + b));
+            merge_shuffled(bound(b), bound(b + width), bound(b + 2 * width), gen);
+        });
+    }
+}
+
+// uniform random permutation of {0, ..., n - 1}
+inline std::vector<int> random_permutation(size_t n, uint64_t seed,
+    int num_threads = 1)
+{
+    std::vector<int> seq(n);
+    for (size_t i = 0; i < n; ++i) {
+        seq[i] = static_cast<int>(i);
+    }
+    merge_shuffle(seq.begin(), seq.end(), seed, num_threads);
+    return seq;
+}
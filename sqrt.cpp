@@ -0,0 +1,102 @@
+#include "sqrt.h"
+#include "ecdh.h"
+
+#include <catch.hpp>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <iostream>
+
+
+// all elements against a table of squares
+template<int64_t p>
+void check_small_field() {
+    using F = PF<p>;
+    std::vector<bool> is_square(p, false);
+    for (int64_t y = 0; y < p; ++y) {
+        is_square[(y * y) % p] = true;
+    }
+    for (int64_t a = 0; a < p; ++a) {
+        const auto root = field_sqrt(F(a));
+        REQUIRE(root.first == is_square[a]);
+        if (root.first) {
+            REQUIRE(root.second * root.second == F(a));
+        }
+    }
+}
+
+// squares have roots, squares times a non-residue have none
+template<typename F>
+void check_random_squares(std::mt19937_64& gen, const F& non_residue) {
+    for (int i = 0; i < 100; ++i) {
+        const F y = F(static_cast<int64_t>(gen() >> 1));
+        const auto root = field_sqrt(y * y);
+        REQUIRE(root.first);
+        REQUIRE((root.second == y || root.second == -y));
+        if (y != F(0)) {
+            REQUIRE(!field_sqrt(non_residue * y * y).first);
+        }
+    }
+}
+
+TEST_CASE("Square roots in small prime fields", "[sqrt]") {
+    check_small_field<71>();    // 3 mod 4
+    check_small_field<61>();    // 5 mod 8
+    check_small_field<101>();   // 5 mod 8
+    check_small_field<41>();    // 1 mod 8, p - 1 = 5 * 2^3
+    check_small_field<257>();   // p - 1 = 2^8
+    check_small_field<7681>();  // p - 1 = 15 * 2^9
+}
+
+TEST_CASE("Square roots in 64-bit prime fields", "[sqrt]") {
+    std::mt19937_64 gen(64);
+    // 3 mod 4, -1 is no square
+    check_random_squares(gen, PF64<(uint64_t(1) << 61) - 1>(-1));
+    // 5 mod 8, 2 is no square
+    check_random_squares(gen, PF64<uint64_t(-59)>(2));
+    // 2^64 - 2^32 + 1 = 1 mod 2^32, 7 is no square
+    check_random_squares(gen, PF64<uint64_t(-1) - (uint64_t(1) << 32) + 2>(7));
+}
+
+TEST_CASE("Square roots in F(2^255 - 19)", "[sqrt][f25519]") {
+    using F = F25519;
+    std::mt19937_64 gen(25519);
+    // 2 is no square, since p = 5 mod 8
+    check_random_squares(gen, F(2));
+
+    const auto i = field_sqrt(F(-1));
+    REQUIRE(i.first);
+    REQUIRE(i.second * i.second == F(-1));
+    REQUIRE(field_sqrt(F(4)).second * field_sqrt(F(4)).second == F(4));
+    REQUIRE(field_sqrt(F(0)).first);
+}
+
+
+// ./sqrt [benchmark]
+TEST_CASE("Square root throughput", "[.][benchmark]") {
+    auto measure = [](const char* name, auto zero) {
+        using F = decltype(zero);
+        std::mt19937_64 gen(42);
+        const int n = 100000;
+        std::vector<F> squares;
+        for (int i = 0; i < n; ++i) {
+            const F y = F(static_cast<int64_t>(gen() >> 1));
+            squares.push_back(y * y);
+        }
+
+        int found = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const F& a : squares) {
+            found += field_sqrt(a).first;
+        }
+        auto end = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed = end - start;
+        std::cout << name << ": " << n / elapsed.count() << " ops/s" << std::endl;
+        return found == n;
+    };
+
+    REQUIRE(measure("2^61 - 1 (3 mod 4)", PF64<(uint64_t(1) << 61) - 1>(0)));
+    REQUIRE(measure("2^64 - 59 (5 mod 8)", PF64<uint64_t(-59)>(0)));
+    REQUIRE(measure("2^64 - 2^32 + 1 (Tonelli-Shanks, s = 32)",
+        PF64<uint64_t(-1) - (uint64_t(1) << 32) + 2>(0)));
+}
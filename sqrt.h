@@ -0,0 +1,151 @@
+#pragma once
+
+#include "f25519.h"
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <assert.h>
+
+//
+// Square roots in prime fields
+//
+// Depending on p, a root of a is
+//
+//   p = 3 mod 4: a^((p + 1)/4), since its square is a^((p - 1)/2) a = a,
+//   p = 5 mod 8: r = a^((p + 3)/8), whose square is a or -a; in the latter
+//                case r sqrt(-1), where sqrt(-1) = 2^((p - 1)/4),
+//   otherwise:   Tonelli-Shanks.
+//
+// All of them return a wrong candidate if a is no square, which is caught
+// by squaring it. Tonelli-Shanks with p - 1 = q 2^s works in the 2-Sylow
+// subgroup generated by c = z^q for a non-residue z. Its powers c^(2^k)
+// are computed once per field, so finding a root costs one exponentiation
+// by (q - 1)/2 and at most s^2/2 squarings.
+//
+// Cf. H. Cohen, "A Course in Computational Algebraic Number Theory",
+// algorithm 1.5.1, and RFC 8032, section 5.1.3.
+//
+
+// x^e
+template<typename F, typename Int>
+F field_pow(F x, Int e) {
+    F res = 1;
+    for (; e > 0; e >>= 1, x = x * x) {
+        if (e & 1) {
+            res = res * x;
+        }
+    }
+    return res;
+}
+
+// parity of the canonical representative, the "sign" of compressed points
+template<typename F>
+bool is_odd(const F& x) {
+    return x() & 1;
+}
+
+inline bool is_odd(const F25519& x) {
+    return x.to_bytes()[0] & 1;
+}
+
+
+// for fields F with a characteristic < 2^64
+template<typename F>
+class SquareRoot {
+public:
+    // one per field
+    static const SquareRoot& instance() {
+        static const SquareRoot sqrt;
+        return sqrt;
+    }
+
+    // (true, r) with r^2 = a, or (false, 0) if a is no square
+    std::pair<bool, F> operator()(const F& a) const {
+        F r = 0;
+        if (p_ % 4 == 3) {
+            r = field_pow(a, (p_ + 1) / 4);
+        } else if (p_ % 8 == 5) {
+            r = field_pow(a, (p_ + 3) / 8);
+            if (r * r != a) {
+                r = r * powers_[0];
+            }
+        } else {
+            r = tonelli_shanks(a);
+        }
+        return r * r == a ? std::make_pair(true, r) : std::make_pair(false, F(0));
+    }
+
+private:
+    SquareRoot() : p_(static_cast<uint64_t>(F::characteristic)), q_(p_ - 1), s_(0) {
+        while (q_ % 2 == 0) {
+            q_ /= 2;
+            s_ += 1;
+        }
+        if (p_ % 8 == 5) {
+            // 2 is a non-residue
+            powers_.push_back(field_pow(F(2), (p_ - 1) / 4));
+        } else if (p_ % 8 == 1) {
+            // Euler's criterion: z^((p - 1)/2) = -1
+            int64_t z = 2;
+            while (field_pow(F(z), (p_ - 1) / 2) == F(1)) {
+                z += 1;
+            }
+            powers_.push_back(field_pow(F(z), q_));
+            for (int k = 1; k < s_; ++k) {
+                powers_.push_back(powers_.back() * powers_.back());
+            }
+        }
+    }
+
+    F tonelli_shanks(const F& a) const {
+        if (a == F(0)) {
+            return a;
+        }
+        // invariant: r^2 = a t, t in the subgroup of order 2^m
+        const F w = field_pow(a, (q_ - 1) / 2);
+        F r = a * w;
+        F t = r * w;
+        int m = s_;
+        while (t != F(1)) {
+            // order of t is 2^i
+            int i = 0;
+            F tt = t;
+            while (tt != F(1) && i < m) {
+                tt = tt * tt;
+                i += 1;
+            }
+            if (i == m) {
+                return F(0);  // no square
+            }
+            // b = c^(2^(m - i - 1)), with c = powers_[0]^(2^(s - m))
+            const F b = powers_[s_ - i - 1];
+            r = r * b;
+            t = t * b * b;
+            m = i;
+        }
+        return r;
+    }
+
+    uint64_t p_;
+    uint64_t q_;  // p - 1 = q 2^s, q odd
+    int s_;
+    std::vector<F> powers_;  // sqrt(-1) if p = 5 mod 8, z^(q 2^k) if p = 1 mod 8
+};
+
+template<typename F>
+std::pair<bool, F> field_sqrt(const F& a) {
+    return SquareRoot<F>::instance()(a);
+}
+
+// p = 2^255 - 19 = 5 mod 8
+inline std::pair<bool, F25519> field_sqrt(const F25519& a) {
+    // 2^((p - 1)/4) = (2^((p - 5)/8))^2 2
+    static const F25519 sqrt_minus_one = F25519(2).pow_p58().square() * F25519(2);
+
+    F25519 r = a.pow_p58() * a;
+    if (r * r != a) {
+        r = r * sqrt_minus_one;
+    }
+    return r * r == a ? std::make_pair(true, r) : std::make_pair(false, F25519(0));
+}